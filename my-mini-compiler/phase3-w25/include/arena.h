@@ -0,0 +1,45 @@
+/* arena.h */
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Bump-pointer arena: allocations are carved out of large chunks and can only be
+// freed all at once, which costs one free() per chunk. Chunks double in size up to
+// ARENA_MAX_CHUNK, so there are few of them. A zeroed arena is empty and ready to use.
+#define ARENA_FIRST_CHUNK (64 * 1024)
+#define ARENA_MAX_CHUNK (16 * 1024 * 1024)
+
+typedef struct ArenaChunk ArenaChunk;
+
+typedef struct {
+    ArenaChunk* chunk; // Current chunk, linked to the ones before it
+    char* next; // Next free byte in the current chunk
+    size_t left; // Free bytes from next to the end of the chunk
+    size_t chunk_size; // Size of the last chunk allocated
+} Arena;
+
+void arena_init(Arena* arena);
+void arena_free(Arena* arena);
+
+// Starts a new chunk for an allocation that does not fit in the current one
+void* arena_alloc_slow(Arena* arena, size_t size);
+
+// Returns size bytes aligned to align (a power of two, at most that of max_align_t),
+// valid until arena_free(), or NULL if out of memory. Objects are packed at their
+// own alignment, so small ones are not padded out to 16 bytes.
+static inline void* arena_alloc(Arena* arena, size_t size, size_t align) {
+    size_t padding = (size_t) -(uintptr_t) arena->next & (align - 1);
+    if (size + padding > arena->left) return arena_alloc_slow(arena, size);
+
+    void* memory = arena->next + padding;
+    arena->next += size + padding;
+    arena->left -= size + padding;
+    return memory;
+}
+
+// Allocate one object of the given type
+#define ARENA_NEW(arena, type) ((type*) arena_alloc((arena), sizeof(type), _Alignof(type)))
+
+#endif /* ARENA_H */
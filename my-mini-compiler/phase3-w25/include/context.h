@@ -0,0 +1,63 @@
+/* context.h */
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include "arena.h"
+#include "lexer.h"
+
+// All state of one compilation lives in a CompilerContext, so independent
+// compilations can run back to back or concurrently on different threads.
+
+// Default limit on nested parentheses and statement bodies, see ParserState.max_depth
+#define PARSER_MAX_DEPTH 1024
+
+// Parser state: the parser walks the token stream by index. The stream is either
+// lexed up front or, in pipelined mode, appended to as a lexer thread produces it.
+typedef struct {
+    TokenBuffer tokens;
+    uint32_t current; // Index of the token being processed
+    struct LexPipeline *pipeline; // Lexer thread still producing tokens, NULL once all are in
+    // Items of the lists being parsed, innermost list on top; a finished list is
+    // copied into the arena, so nested lists share this one growable stack
+    struct ASTNode **items;
+    uint32_t item_count;
+    uint32_t item_capacity;
+    uint32_t depth; // Parentheses and statement bodies open around the token being processed
+    // Deepest nesting of parentheses and statement bodies (blocks, and the bodies of
+    // if, while and repeat with or without braces) parsed; a construct nested deeper is
+    // reported and skipped, which bounds the native stack the parser and the statement
+    // passes use. Operator chains are not nesting; passes walk those with heap stacks.
+    uint32_t max_depth;
+} ParserState;
+
+// Receives each diagnostic as one formatted line, without the trailing newline
+typedef void (*DiagnosticHandler)(void *user_data, const char *message);
+
+typedef struct {
+    DiagnosticHandler handler; // NULL prints to stdout
+    void *user_data;
+    int error_count;
+} DiagnosticSink;
+
+typedef struct CompilerContext {
+    Lexer lexer;
+    InternTable interns; // Identifier names of the compilation
+    SourceMap source_map; // Line and column lookup for diagnostics
+    ParserState parser;
+    Arena ast; // Every AST node of the compilation
+    DiagnosticSink diagnostics;
+} CompilerContext;
+
+// Initialize a context with diagnostics going to stdout
+void context_init(CompilerContext *ctx);
+
+// Release what a compilation allocated in the context
+void context_free(CompilerContext *ctx);
+
+// Route diagnostics to a custom handler
+void context_set_diagnostic_handler(CompilerContext *ctx, DiagnosticHandler handler, void *user_data);
+
+// Format and report one diagnostic through the context's sink
+void report_diagnostic(CompilerContext *ctx, const char *format, ...);
+
+#endif /* CONTEXT_H */
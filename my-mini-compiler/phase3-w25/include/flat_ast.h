@@ -0,0 +1,75 @@
+/* flat_ast.h */
+#ifndef FLAT_AST_H
+#define FLAT_AST_H
+
+#include <stdint.h>
+
+#include "parser.h"
+
+// Flat AST: the whole tree in one contiguous array in postorder, children linked
+// by index. Every child comes before its parent and the nodes of a subtree are a
+// contiguous range ending at its root, so a pass that handles children before
+// parents (type checking, constant folding, code generation) is a single loop:
+//
+//     for (uint32_t i = 0; i < flat->count; i++) { FlatNode *node = &flat->nodes[i]; ... }
+//
+// and a pass over one subtree loops from flat_ast_first(flat, root) to root. A list
+// node (see ast_is_list()) has no left child; its right child is its last item and
+// flat_ast_previous() steps back through the others. The array holds no pointers,
+// so it can be written out, mapped back in or shared between threads as it is.
+#define FLAT_NONE UINT32_MAX // Index of a missing child
+
+typedef struct {
+    uint8_t type; // ASTNodeType
+    uint8_t op; // TokenType of the node's token
+    uint32_t token; // Index of the node's token in ctx->parser.tokens
+    uint32_t left; // Index of the left child, or FLAT_NONE
+    uint32_t right; // Index of the right child, or FLAT_NONE
+    uint32_t first; // Index of the first node of this node's subtree
+} FlatNode;
+
+typedef struct {
+    FlatNode* nodes;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t root; // Index of the root, the last node; FLAT_NONE for an empty tree
+} FlatAST;
+
+void flat_ast_init(FlatAST* flat);
+void flat_ast_free(FlatAST* flat);
+
+// Lay out the tree under root (as returned by parse()) in postorder, replacing
+// what flat held. Walks the tree with a heap-allocated stack, so any depth is fine.
+// Returns 0 on success, -1 if out of memory.
+int flat_ast_build(FlatAST* flat, const ASTNode* root);
+
+// First index of the subtree rooted at index; the subtree is [first, index]
+static inline uint32_t flat_ast_first(const FlatAST* flat, uint32_t index) {
+    return flat->nodes[index].first;
+}
+
+// The item of a list before the one at index, or FLAT_NONE past the list's first:
+//     for (uint32_t i = list->right; i != FLAT_NONE; i = flat_ast_previous(flat, list_index, i))
+static inline uint32_t flat_ast_previous(const FlatAST* flat, uint32_t list, uint32_t index) {
+    uint32_t first = flat->nodes[index].first;
+    return first > flat->nodes[list].first ? first - 1 : FLAT_NONE;
+}
+
+// Number of nodes in the subtree rooted at index
+static inline uint32_t flat_ast_size(const FlatAST* flat, uint32_t index) {
+    return index - flat->nodes[index].first + 1;
+}
+
+// The token of a flat node, like ast_token()
+static inline Token flat_ast_token(const CompilerContext* ctx, const FlatNode* node) {
+    if (node->token >= ctx->parser.tokens.count) {
+        Token eof = {.type = TOKEN_EOF, .offset = (int) ctx->lexer.position, .error = ERROR_NONE};
+        return eof;
+    }
+    return token_at(&ctx->parser.tokens, node->token);
+}
+
+// Print the nodes in postorder, one per line with its index and children (for debugging)
+void print_flat_ast(CompilerContext* ctx, const FlatAST* flat);
+
+#endif /* FLAT_AST_H */
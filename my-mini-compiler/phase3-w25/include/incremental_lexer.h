@@ -0,0 +1,31 @@
+/* incremental_lexer.h */
+#ifndef INCREMENTAL_LEXER_H
+#define INCREMENTAL_LEXER_H
+
+#include "lexer.h"
+
+// One edit of the source: `removed` bytes at `offset` were replaced by `inserted` bytes
+typedef struct {
+    uint32_t offset;
+    uint32_t removed;
+    uint32_t inserted;
+} LexEdit;
+
+// Tokens [first, old_end) of the previous stream were replaced by [first, new_end).
+// The tokens after them are the same as before, moved by the edit's length change.
+typedef struct {
+    uint32_t first;
+    uint32_t old_end;
+    uint32_t new_end;
+} TokenRange;
+
+// Bring `tokens`, the whole token stream of the source before the edit (as lex_all()
+// produces it from position 0), up to date with lexer->source, the source after the
+// edit. Lexing restarts at the last token that begins before the edit and stops as
+// soon as the new stream falls back into step with the old one, so a small edit
+// costs a few tokens plus moving the token arrays behind it. lexer->interns is used
+// as in lex_all(); the rest of the lexer state is overwritten.
+// Returns 0 on success, -1 if out of memory, in which case tokens is left as it was.
+int lex_edit(Lexer* lexer, TokenBuffer* tokens, const LexEdit* edit, TokenRange* changed);
+
+#endif /* INCREMENTAL_LEXER_H */
@@ -0,0 +1,41 @@
+/* intern.h */
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stdint.h>
+
+// Intern table: maps every distinct identifier name to a dense ID starting at 1,
+// so names can be compared as integers. Each name's bytes are stored once.
+// ID 0 never names anything. A zeroed table is empty and ready to use.
+typedef struct {
+    char* bytes; // Every name, each followed by a NUL
+    uint32_t bytes_used;
+    uint32_t bytes_capacity;
+
+    // Indexed by ID
+    uint32_t* name_offset; // Start of the name in bytes
+    uint32_t* name_length;
+    uint32_t* name_hash;
+    uint32_t count; // Number of names; IDs run from 1 to count
+    uint32_t capacity;
+
+    uint32_t* slots; // Open-addressed hash of IDs, 0 marks an empty slot
+    uint32_t slot_mask;
+} InternTable;
+
+void intern_init(InternTable* table);
+void intern_free(InternTable* table);
+
+// Returns the ID of name[0..length), adding it if it is new. Returns 0 if out of memory.
+uint32_t intern(InternTable* table, const char* name, uint32_t length);
+
+// NUL-terminated name of an ID; valid until the next call to intern()
+static inline const char* intern_name(const InternTable* table, uint32_t id) {
+    return table->bytes + table->name_offset[id];
+}
+
+static inline uint32_t intern_length(const InternTable* table, uint32_t id) {
+    return table->name_length[id];
+}
+
+#endif /* INTERN_H */
@@ -2,11 +2,27 @@
 #ifndef LEXER_H
 #define LEXER_H
 
+#include <stddef.h>
+
+#include "intern.h"
+#include "source_map.h"
 #include "tokens.h"
+#include "token_buffer.h"
+
+// Lexer state: where we are in the source and what the lexer remembers between tokens
+typedef struct {
+    const char* source; // NUL-terminated source buffer
+    int position; // Index of the next unread byte
+    char last_token_type; // 'o' once an arithmetic operator was seen
+    InternTable* interns; // Identifier names are interned here when set
+} Lexer;
 
 // Lexer functions that need to be visible to other files
-Token get_next_token(const char* input, int* pos);
-void print_token(Token token);
-void print_error(ErrorType error, int line, const char* lexeme);
+void lexer_init(Lexer* lexer, const char* input);
+Token get_next_token(Lexer* lexer);
+int lex_all(Lexer* lexer, TokenBuffer* tokens);
+void print_token(Token token, const char* input, SourceLocation location);
+const char* token_lexeme(Token token, const char* input, char* buffer, size_t size);
+void print_error(ErrorType error, SourceLocation location, const char* lexeme);
 
 #endif /* LEXER_H */
\ No newline at end of file
@@ -0,0 +1,354 @@
+/* lexer_tables.h */
+#ifndef LEXER_TABLES_H
+#define LEXER_TABLES_H
+
+#include "tokens.h"
+
+// Tables driving the lexer's token DFA (see get_next_token() in lexer.c).
+// Every source byte is first mapped to a character class, and the DFA
+// advances with one lookup per byte in lex_transitions until it lands in an
+// accepting state, whose lex_accepts entry gives the token type and error.
+
+typedef enum {
+    CC_OTHER,       // Anything that cannot start or continue a token
+    CC_DIGIT,       // 0-9
+    CC_ALPHA,       // a-z A-Z
+    CC_UNDERSCORE,  // _
+    CC_DOT,         // .
+    CC_QUOTE,       // " and '
+    CC_EQUALS,      // =
+    CC_BANG,        // !
+    CC_AMP,         // &
+    CC_BAR,         // |
+    CC_OPERATOR,    // + - * /
+    CC_PUNCTUATION, // < > ; ( ) { }
+    CC_COMMA,       // ,
+    CC_NON_ASCII,   // 0x80-0xFF, part of a UTF-8 sequence
+    CC_COUNT
+} CharClass;
+
+typedef enum {
+    // Scanning states
+    LEX_START,
+    LEX_NUMBER,          // Digits
+    LEX_DECIMAL,         // Digits with one '.'
+    LEX_BAD_NUMBER,      // Digits with more than one '.'
+    LEX_BAD_IDENTIFIER,  // Number running into letters
+    LEX_IDENTIFIER,
+    LEX_EQUALS,          // '=' or '=='
+    LEX_BANG,            // '!' or '!='
+    LEX_AMP,             // '&' or '&&'
+    LEX_BAR,             // '|' or '||'
+
+    // Accepting states, see lex_accepts
+    LEX_ACCEPT_NUMBER,
+    LEX_ACCEPT_BAD_NUMBER,
+    LEX_ACCEPT_BAD_IDENTIFIER,
+    LEX_ACCEPT_IDENTIFIER,
+    LEX_ACCEPT_ASSIGN,
+    LEX_ACCEPT_EQ,
+    LEX_ACCEPT_FACTORIAL,
+    LEX_ACCEPT_NEQ,
+    LEX_ACCEPT_ADDRESS,
+    LEX_ACCEPT_AND,
+    LEX_ACCEPT_BAR,
+    LEX_ACCEPT_OR,
+    LEX_ACCEPT_OPERATOR,     // Type from punctuation_tokens, consecutive operator check applies
+    LEX_ACCEPT_PUNCTUATION,  // Type from punctuation_tokens
+    LEX_ACCEPT_COMMA,
+    LEX_ACCEPT_QUOTE,        // Start of a string or char literal
+    LEX_ACCEPT_NON_ASCII,    // Start of a UTF-8 character: an identifier or an invalid character
+    LEX_ACCEPT_INVALID,
+    LEX_STATE_COUNT
+} LexState;
+
+#define LEX_FIRST_ACCEPT LEX_ACCEPT_NUMBER
+
+static const unsigned char char_class[256] = {
+    /* 0x00-0x0F */
+    CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER,
+    CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER,
+    CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER,
+    CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER,
+    /* 0x10-0x1F */
+    CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER,
+    CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER,
+    CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER,
+    CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER,
+    /* 0x20-0x2F */
+    CC_OTHER, CC_BANG, CC_QUOTE, CC_OTHER,
+    CC_OTHER, CC_OTHER, CC_AMP, CC_QUOTE,
+    CC_PUNCTUATION, CC_PUNCTUATION, CC_OPERATOR, CC_OPERATOR,
+    CC_COMMA, CC_OPERATOR, CC_DOT, CC_OPERATOR,
+    /* 0x30-0x3F */
+    CC_DIGIT, CC_DIGIT, CC_DIGIT, CC_DIGIT,
+    CC_DIGIT, CC_DIGIT, CC_DIGIT, CC_DIGIT,
+    CC_DIGIT, CC_DIGIT, CC_OTHER, CC_PUNCTUATION,
+    CC_PUNCTUATION, CC_EQUALS, CC_PUNCTUATION, CC_OTHER,
+    /* 0x40-0x4F */
+    CC_OTHER, CC_ALPHA, CC_ALPHA, CC_ALPHA,
+    CC_ALPHA, CC_ALPHA, CC_ALPHA, CC_ALPHA,
+    CC_ALPHA, CC_ALPHA, CC_ALPHA, CC_ALPHA,
+    CC_ALPHA, CC_ALPHA, CC_ALPHA, CC_ALPHA,
+    /* 0x50-0x5F */
+    CC_ALPHA, CC_ALPHA, CC_ALPHA, CC_ALPHA,
+    CC_ALPHA, CC_ALPHA, CC_ALPHA, CC_ALPHA,
+    CC_ALPHA, CC_ALPHA, CC_ALPHA, CC_OTHER,
+    CC_OTHER, CC_OTHER, CC_OTHER, CC_UNDERSCORE,
+    /* 0x60-0x6F */
+    CC_OTHER, CC_ALPHA, CC_ALPHA, CC_ALPHA,
+    CC_ALPHA, CC_ALPHA, CC_ALPHA, CC_ALPHA,
+    CC_ALPHA, CC_ALPHA, CC_ALPHA, CC_ALPHA,
+    CC_ALPHA, CC_ALPHA, CC_ALPHA, CC_ALPHA,
+    /* 0x70-0x7F */
+    CC_ALPHA, CC_ALPHA, CC_ALPHA, CC_ALPHA,
+    CC_ALPHA, CC_ALPHA, CC_ALPHA, CC_ALPHA,
+    CC_ALPHA, CC_ALPHA, CC_ALPHA, CC_PUNCTUATION,
+    CC_BAR, CC_PUNCTUATION, CC_OTHER, CC_OTHER,
+    /* 0x80-0x8F */
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    /* 0x90-0x9F */
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    /* 0xA0-0xAF */
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    /* 0xB0-0xBF */
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    /* 0xC0-0xCF */
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    /* 0xD0-0xDF */
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    /* 0xE0-0xEF */
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    /* 0xF0-0xFF */
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+    CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII, CC_NON_ASCII,
+};
+
+static const unsigned char lex_transitions[LEX_FIRST_ACCEPT][CC_COUNT] = {
+    [LEX_START] = {
+        [CC_OTHER] = LEX_ACCEPT_INVALID,
+        [CC_DIGIT] = LEX_NUMBER,
+        [CC_ALPHA] = LEX_IDENTIFIER,
+        [CC_UNDERSCORE] = LEX_IDENTIFIER,
+        [CC_DOT] = LEX_ACCEPT_INVALID,
+        [CC_QUOTE] = LEX_ACCEPT_QUOTE,
+        [CC_EQUALS] = LEX_EQUALS,
+        [CC_BANG] = LEX_BANG,
+        [CC_AMP] = LEX_AMP,
+        [CC_BAR] = LEX_BAR,
+        [CC_OPERATOR] = LEX_ACCEPT_OPERATOR,
+        [CC_PUNCTUATION] = LEX_ACCEPT_PUNCTUATION,
+        [CC_COMMA] = LEX_ACCEPT_COMMA,
+        [CC_NON_ASCII] = LEX_ACCEPT_NON_ASCII,
+    },
+    [LEX_NUMBER] = {
+        [CC_OTHER] = LEX_ACCEPT_NUMBER,
+        [CC_DIGIT] = LEX_NUMBER,
+        [CC_ALPHA] = LEX_BAD_IDENTIFIER,
+        [CC_UNDERSCORE] = LEX_ACCEPT_BAD_IDENTIFIER,
+        [CC_DOT] = LEX_DECIMAL,
+        [CC_QUOTE] = LEX_ACCEPT_NUMBER,
+        [CC_EQUALS] = LEX_ACCEPT_NUMBER,
+        [CC_BANG] = LEX_ACCEPT_NUMBER,
+        [CC_AMP] = LEX_ACCEPT_NUMBER,
+        [CC_BAR] = LEX_ACCEPT_NUMBER,
+        [CC_OPERATOR] = LEX_ACCEPT_NUMBER,
+        [CC_PUNCTUATION] = LEX_ACCEPT_NUMBER,
+        [CC_COMMA] = LEX_ACCEPT_NUMBER,
+        [CC_NON_ASCII] = LEX_ACCEPT_NUMBER,
+    },
+    [LEX_DECIMAL] = {
+        [CC_OTHER] = LEX_ACCEPT_NUMBER,
+        [CC_DIGIT] = LEX_DECIMAL,
+        [CC_ALPHA] = LEX_BAD_IDENTIFIER,
+        [CC_UNDERSCORE] = LEX_ACCEPT_BAD_IDENTIFIER,
+        [CC_DOT] = LEX_BAD_NUMBER,
+        [CC_QUOTE] = LEX_ACCEPT_NUMBER,
+        [CC_EQUALS] = LEX_ACCEPT_NUMBER,
+        [CC_BANG] = LEX_ACCEPT_NUMBER,
+        [CC_AMP] = LEX_ACCEPT_NUMBER,
+        [CC_BAR] = LEX_ACCEPT_NUMBER,
+        [CC_OPERATOR] = LEX_ACCEPT_NUMBER,
+        [CC_PUNCTUATION] = LEX_ACCEPT_NUMBER,
+        [CC_COMMA] = LEX_ACCEPT_NUMBER,
+        [CC_NON_ASCII] = LEX_ACCEPT_NUMBER,
+    },
+    [LEX_BAD_NUMBER] = {
+        [CC_OTHER] = LEX_ACCEPT_BAD_NUMBER,
+        [CC_DIGIT] = LEX_BAD_NUMBER,
+        [CC_ALPHA] = LEX_BAD_IDENTIFIER,
+        [CC_UNDERSCORE] = LEX_ACCEPT_BAD_IDENTIFIER,
+        [CC_DOT] = LEX_BAD_NUMBER,
+        [CC_QUOTE] = LEX_ACCEPT_BAD_NUMBER,
+        [CC_EQUALS] = LEX_ACCEPT_BAD_NUMBER,
+        [CC_BANG] = LEX_ACCEPT_BAD_NUMBER,
+        [CC_AMP] = LEX_ACCEPT_BAD_NUMBER,
+        [CC_BAR] = LEX_ACCEPT_BAD_NUMBER,
+        [CC_OPERATOR] = LEX_ACCEPT_BAD_NUMBER,
+        [CC_PUNCTUATION] = LEX_ACCEPT_BAD_NUMBER,
+        [CC_COMMA] = LEX_ACCEPT_BAD_NUMBER,
+        [CC_NON_ASCII] = LEX_ACCEPT_BAD_NUMBER,
+    },
+    [LEX_BAD_IDENTIFIER] = {
+        [CC_OTHER] = LEX_ACCEPT_BAD_IDENTIFIER,
+        [CC_DIGIT] = LEX_BAD_IDENTIFIER,
+        [CC_ALPHA] = LEX_BAD_IDENTIFIER,
+        [CC_UNDERSCORE] = LEX_ACCEPT_BAD_IDENTIFIER,
+        [CC_DOT] = LEX_ACCEPT_BAD_IDENTIFIER,
+        [CC_QUOTE] = LEX_ACCEPT_BAD_IDENTIFIER,
+        [CC_EQUALS] = LEX_ACCEPT_BAD_IDENTIFIER,
+        [CC_BANG] = LEX_ACCEPT_BAD_IDENTIFIER,
+        [CC_AMP] = LEX_ACCEPT_BAD_IDENTIFIER,
+        [CC_BAR] = LEX_ACCEPT_BAD_IDENTIFIER,
+        [CC_OPERATOR] = LEX_ACCEPT_BAD_IDENTIFIER,
+        [CC_PUNCTUATION] = LEX_ACCEPT_BAD_IDENTIFIER,
+        [CC_COMMA] = LEX_ACCEPT_BAD_IDENTIFIER,
+        [CC_NON_ASCII] = LEX_ACCEPT_BAD_IDENTIFIER,
+    },
+    [LEX_IDENTIFIER] = {
+        [CC_OTHER] = LEX_ACCEPT_IDENTIFIER,
+        [CC_DIGIT] = LEX_IDENTIFIER,
+        [CC_ALPHA] = LEX_IDENTIFIER,
+        [CC_UNDERSCORE] = LEX_IDENTIFIER,
+        [CC_DOT] = LEX_ACCEPT_IDENTIFIER,
+        [CC_QUOTE] = LEX_ACCEPT_IDENTIFIER,
+        [CC_EQUALS] = LEX_ACCEPT_IDENTIFIER,
+        [CC_BANG] = LEX_ACCEPT_IDENTIFIER,
+        [CC_AMP] = LEX_ACCEPT_IDENTIFIER,
+        [CC_BAR] = LEX_ACCEPT_IDENTIFIER,
+        [CC_OPERATOR] = LEX_ACCEPT_IDENTIFIER,
+        [CC_PUNCTUATION] = LEX_ACCEPT_IDENTIFIER,
+        [CC_COMMA] = LEX_ACCEPT_IDENTIFIER,
+        [CC_NON_ASCII] = LEX_ACCEPT_IDENTIFIER,
+    },
+    [LEX_EQUALS] = {
+        [CC_OTHER] = LEX_ACCEPT_ASSIGN,
+        [CC_DIGIT] = LEX_ACCEPT_ASSIGN,
+        [CC_ALPHA] = LEX_ACCEPT_ASSIGN,
+        [CC_UNDERSCORE] = LEX_ACCEPT_ASSIGN,
+        [CC_DOT] = LEX_ACCEPT_ASSIGN,
+        [CC_QUOTE] = LEX_ACCEPT_ASSIGN,
+        [CC_EQUALS] = LEX_ACCEPT_EQ,
+        [CC_BANG] = LEX_ACCEPT_ASSIGN,
+        [CC_AMP] = LEX_ACCEPT_ASSIGN,
+        [CC_BAR] = LEX_ACCEPT_ASSIGN,
+        [CC_OPERATOR] = LEX_ACCEPT_ASSIGN,
+        [CC_PUNCTUATION] = LEX_ACCEPT_ASSIGN,
+        [CC_COMMA] = LEX_ACCEPT_ASSIGN,
+        [CC_NON_ASCII] = LEX_ACCEPT_ASSIGN,
+    },
+    [LEX_BANG] = {
+        [CC_OTHER] = LEX_ACCEPT_FACTORIAL,
+        [CC_DIGIT] = LEX_ACCEPT_FACTORIAL,
+        [CC_ALPHA] = LEX_ACCEPT_FACTORIAL,
+        [CC_UNDERSCORE] = LEX_ACCEPT_FACTORIAL,
+        [CC_DOT] = LEX_ACCEPT_FACTORIAL,
+        [CC_QUOTE] = LEX_ACCEPT_FACTORIAL,
+        [CC_EQUALS] = LEX_ACCEPT_NEQ,
+        [CC_BANG] = LEX_ACCEPT_FACTORIAL,
+        [CC_AMP] = LEX_ACCEPT_FACTORIAL,
+        [CC_BAR] = LEX_ACCEPT_FACTORIAL,
+        [CC_OPERATOR] = LEX_ACCEPT_FACTORIAL,
+        [CC_PUNCTUATION] = LEX_ACCEPT_FACTORIAL,
+        [CC_COMMA] = LEX_ACCEPT_FACTORIAL,
+        [CC_NON_ASCII] = LEX_ACCEPT_FACTORIAL,
+    },
+    [LEX_AMP] = {
+        [CC_OTHER] = LEX_ACCEPT_ADDRESS,
+        [CC_DIGIT] = LEX_ACCEPT_ADDRESS,
+        [CC_ALPHA] = LEX_ACCEPT_ADDRESS,
+        [CC_UNDERSCORE] = LEX_ACCEPT_ADDRESS,
+        [CC_DOT] = LEX_ACCEPT_ADDRESS,
+        [CC_QUOTE] = LEX_ACCEPT_ADDRESS,
+        [CC_EQUALS] = LEX_ACCEPT_ADDRESS,
+        [CC_BANG] = LEX_ACCEPT_ADDRESS,
+        [CC_AMP] = LEX_ACCEPT_AND,
+        [CC_BAR] = LEX_ACCEPT_ADDRESS,
+        [CC_OPERATOR] = LEX_ACCEPT_ADDRESS,
+        [CC_PUNCTUATION] = LEX_ACCEPT_ADDRESS,
+        [CC_COMMA] = LEX_ACCEPT_ADDRESS,
+        [CC_NON_ASCII] = LEX_ACCEPT_ADDRESS,
+    },
+    [LEX_BAR] = {
+        [CC_OTHER] = LEX_ACCEPT_BAR,
+        [CC_DIGIT] = LEX_ACCEPT_BAR,
+        [CC_ALPHA] = LEX_ACCEPT_BAR,
+        [CC_UNDERSCORE] = LEX_ACCEPT_BAR,
+        [CC_DOT] = LEX_ACCEPT_BAR,
+        [CC_QUOTE] = LEX_ACCEPT_BAR,
+        [CC_EQUALS] = LEX_ACCEPT_BAR,
+        [CC_BANG] = LEX_ACCEPT_BAR,
+        [CC_AMP] = LEX_ACCEPT_BAR,
+        [CC_BAR] = LEX_ACCEPT_OR,
+        [CC_OPERATOR] = LEX_ACCEPT_BAR,
+        [CC_PUNCTUATION] = LEX_ACCEPT_BAR,
+        [CC_COMMA] = LEX_ACCEPT_BAR,
+        [CC_NON_ASCII] = LEX_ACCEPT_BAR,
+    },
+};
+
+// consume: whether the byte that led into the accepting state belongs to the token
+static const struct {
+    TokenType type;
+    ErrorType error;
+    unsigned char consume;
+} lex_accepts[LEX_STATE_COUNT - LEX_FIRST_ACCEPT] = {
+    [LEX_ACCEPT_NUMBER - LEX_FIRST_ACCEPT] = {TOKEN_NUMBER, ERROR_NONE, 0},
+    [LEX_ACCEPT_BAD_NUMBER - LEX_FIRST_ACCEPT] = {TOKEN_NUMBER, ERROR_INVALID_NUMBER, 0},
+    [LEX_ACCEPT_BAD_IDENTIFIER - LEX_FIRST_ACCEPT] = {TOKEN_ERROR, ERROR_INVALID_IDENTIFIER, 0},
+    [LEX_ACCEPT_IDENTIFIER - LEX_FIRST_ACCEPT] = {TOKEN_IDENTIFIER, ERROR_NONE, 0},
+    [LEX_ACCEPT_ASSIGN - LEX_FIRST_ACCEPT] = {TOKEN_ASSIGN, ERROR_NONE, 0},
+    [LEX_ACCEPT_EQ - LEX_FIRST_ACCEPT] = {TOKEN_EQ, ERROR_NONE, 1},
+    [LEX_ACCEPT_FACTORIAL - LEX_FIRST_ACCEPT] = {TOKEN_FACTORIAL, ERROR_NONE, 0},
+    [LEX_ACCEPT_NEQ - LEX_FIRST_ACCEPT] = {TOKEN_NEQ, ERROR_NONE, 1},
+    [LEX_ACCEPT_ADDRESS - LEX_FIRST_ACCEPT] = {TOKEN_ADDRESS, ERROR_NONE, 0},
+    [LEX_ACCEPT_AND - LEX_FIRST_ACCEPT] = {TOKEN_AND, ERROR_NONE, 1},
+    [LEX_ACCEPT_BAR - LEX_FIRST_ACCEPT] = {TOKEN_ERROR, ERROR_NONE, 0}, // A lone '|'
+    [LEX_ACCEPT_OR - LEX_FIRST_ACCEPT] = {TOKEN_OR, ERROR_NONE, 1},
+    [LEX_ACCEPT_OPERATOR - LEX_FIRST_ACCEPT] = {TOKEN_ERROR, ERROR_NONE, 1},
+    [LEX_ACCEPT_PUNCTUATION - LEX_FIRST_ACCEPT] = {TOKEN_ERROR, ERROR_NONE, 1},
+    [LEX_ACCEPT_COMMA - LEX_FIRST_ACCEPT] = {TOKEN_COMMA, ERROR_INVALID_CHAR, 1},
+    [LEX_ACCEPT_QUOTE - LEX_FIRST_ACCEPT] = {TOKEN_STRING, ERROR_NONE, 1},
+    [LEX_ACCEPT_NON_ASCII - LEX_FIRST_ACCEPT] = {TOKEN_ERROR, ERROR_INVALID_CHAR, 1},
+    [LEX_ACCEPT_INVALID - LEX_FIRST_ACCEPT] = {TOKEN_ERROR, ERROR_INVALID_CHAR, 1},
+};
+
+// Token types of the single character operators and punctuation
+static const TokenType punctuation_tokens[256] = {
+    ['+'] = TOKEN_PLUS,
+    ['-'] = TOKEN_MINUS,
+    ['*'] = TOKEN_STAR,
+    ['/'] = TOKEN_SLASH,
+    ['<'] = TOKEN_LT,
+    ['>'] = TOKEN_GT,
+    [';'] = TOKEN_SEMICOLON,
+    ['('] = TOKEN_LPAREN,
+    [')'] = TOKEN_RPAREN,
+    ['{'] = TOKEN_LBRACE,
+    ['}'] = TOKEN_RBRACE,
+};
+
+#endif /* LEXER_TABLES_H */
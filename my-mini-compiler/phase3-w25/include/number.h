@@ -0,0 +1,12 @@
+/* number.h */
+#ifndef NUMBER_H
+#define NUMBER_H
+
+#include "tokens.h"
+
+// Value of the numeric literal text[0..length), which must be digits with at most
+// one '.' as the lexer accepts them. Literals with a '.' are decimal; an integer
+// too large for int64_t saturates at INT64_MAX and is flagged NUMBER_OVERFLOW.
+NumberValue convert_number(const char* text, int length);
+
+#endif /* NUMBER_H */
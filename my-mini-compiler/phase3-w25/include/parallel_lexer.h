@@ -0,0 +1,18 @@
+/* parallel_lexer.h */
+#ifndef PARALLEL_LEXER_H
+#define PARALLEL_LEXER_H
+
+#include "lexer.h"
+
+// Smallest chunk worth handing to a thread of its own
+#ifndef PARALLEL_LEX_MIN_CHUNK
+#define PARALLEL_LEX_MIN_CHUNK (1 << 20)
+#endif
+
+// Parallel lex_all(): split the rest of the lexer's input at newlines, lex the
+// chunks on up to `threads` threads (0 means one per online CPU) and stitch the
+// results together. The tokens appended to `tokens` and the final lexer state are
+// exactly what lex_all() would produce. Returns 0 on success, -1 if out of memory.
+int lex_all_parallel(Lexer* lexer, TokenBuffer* tokens, int threads);
+
+#endif /* PARALLEL_LEXER_H */
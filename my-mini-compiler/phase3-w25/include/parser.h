@@ -2,7 +2,7 @@
 #ifndef PARSER_H
 #define PARSER_H
 
-#include "tokens.h"
+#include "context.h"
 
 // Basic node types for AST
 typedef enum {
@@ -22,7 +22,8 @@ typedef enum {
     AST_COMPARISONOP,
     AST_BOOLOP,
     AST_FUNCDECL,
-    AST_PARAM
+    AST_PARAM,
+    AST_PARAM_LIST
 } ASTNodeType;
 
 typedef enum {
@@ -37,32 +38,57 @@ typedef enum {
     PARSE_ERROR_MISSING_BLOCK_BRACES,
     PARSE_ERROR_INVALID_OPERATOR,
     PARSE_ERROR_FUNCTION_CALL_ERROR,
-    PARSE_ERROR_UNDECLARED_VARIABLE
+    PARSE_ERROR_UNDECLARED_VARIABLE,
+    PARSE_ERROR_NESTING_TOO_DEEP
 } ParseError;
 
 
-// AST Node structure
+// AST Node structure; nodes are allocated from the context's arena (ctx->ast) and
+// are all freed together by context_free(). The node refers to its token by index
+// into ctx->parser.tokens (see ast_token()), which keeps it at 24 bytes.
 typedef struct ASTNode {
-    ASTNodeType type;           // Type of node
-    Token token;               // Token associated with this node
-    struct ASTNode* left;      // Left child
-    struct ASTNode* right;     // Right child
-    // TODO: Add more fields if needed
+    uint8_t type;              // ASTNodeType of the node
+    uint8_t op;                // TokenType of the node's token, e.g. the operator of a BINOP
+    uint32_t token;            // Index of the token associated with this node
+    union {
+        struct {
+            struct ASTNode* left;      // Left child
+            struct ASTNode* right;     // Right child
+        };
+        // Lists (AST_PROGRAM, AST_BLOCK, AST_PARAM_LIST) hold their statements or
+        // parameters in one array, also in the arena, instead of two children
+        struct {
+            struct ASTNode** items;
+            uint32_t count;
+        };
+    };
 } ASTNode;
 
+// Whether a node of the given type is a list
+static inline int ast_is_list(int type) {
+    return type == AST_PROGRAM || type == AST_BLOCK || type == AST_PARAM_LIST;
+}
+
 // Parser functions
-void parser_init(const char* input);
-ASTNode* parse(void);
-void print_ast(ASTNode* node, int level);
-void free_ast(ASTNode* node);
+void parser_init(CompilerContext* ctx, const char* input);
+// Like parser_init(), but lexes on a thread of its own while parse() runs (see
+// pipelined_lexer.h); falls back to parser_init() where no thread can be started
+void parser_init_pipelined(CompilerContext* ctx, const char* input);
+ASTNode* parse(CompilerContext* ctx);
+void print_ast(CompilerContext* ctx, ASTNode* node, int level);
+
+// The token associated with a node; an EOF token if lexing stopped short of it.
+// Inline so a pass that only needs one field reads just that array.
+static inline Token ast_token(const CompilerContext* ctx, const ASTNode* node) {
+    if (node->token >= ctx->parser.tokens.count) {
+        Token eof = {.type = TOKEN_EOF, .offset = (int) ctx->lexer.position, .error = ERROR_NONE};
+        return eof;
+    }
+    return token_at(&ctx->parser.tokens, node->token);
+}
 
-static ASTNode *parse_statement(void);
-static ASTNode *parse_bool(void);
-static ASTNode *parse_join(void);
-static ASTNode *parse_equality(void);
-static ASTNode *parse_relational(void);
-static ASTNode *parse_expression(void);
-static ASTNode *parse_term(void);
-static ASTNode* parse_unary(void);
+static ASTNode *parse_statement(CompilerContext *ctx);
+static ASTNode *parse_expression(CompilerContext *ctx);
+static ASTNode* parse_unary(CompilerContext *ctx);
 
 #endif /* PARSER_H */
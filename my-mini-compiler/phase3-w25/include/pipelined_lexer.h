@@ -0,0 +1,35 @@
+/* pipelined_lexer.h */
+#ifndef PIPELINED_LEXER_H
+#define PIPELINED_LEXER_H
+
+#include "lexer.h"
+
+// Tokens in flight between the lexer thread and the parser; a power of two. When
+// the ring is full the lexer thread waits for the parser to catch up.
+#ifndef LEX_PIPELINE_CAPACITY
+#define LEX_PIPELINE_CAPACITY 4096
+#endif
+
+// Pipelined lexing: the lexer runs on a thread of its own and hands its tokens to
+// the parser through a lock-free single-producer/single-consumer ring, so lexing
+// the rest of the input overlaps parsing what is already there.
+typedef struct LexPipeline LexPipeline;
+
+// Start lexing the rest of lexer's input on a new thread. The lexer (and its intern
+// table) belongs to that thread until lex_pipeline_finish(). Returns NULL if the
+// thread cannot be started, the platform has none or there is only one CPU to run
+// it on; the caller then lexes up front.
+LexPipeline* lex_pipeline_start(Lexer* lexer);
+
+// Append the tokens the lexer thread has produced since the last call to `tokens`,
+// waiting until there is at least one. The tokens come out exactly as lex_all()
+// would append them. Returns 1 if tokens were appended, 0 once the stream is over
+// (after its TOKEN_EOF, or after the lexer thread ran out of memory), -1 if out of
+// memory growing `tokens`.
+int lex_pipeline_read(LexPipeline* pipeline, TokenBuffer* tokens);
+
+// Stop the lexer thread if it is still running, wait for it and free the pipeline.
+// Returns 0, or -1 if the lexer thread ran out of memory and the stream was cut short.
+int lex_pipeline_finish(LexPipeline* pipeline);
+
+#endif /* PIPELINED_LEXER_H */
@@ -0,0 +1,55 @@
+/* scan.h */
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Bulk byte scanners used by the lexer. Each one works on a NUL-terminated
+// buffer and uses SSE2/AVX2 where the CPU supports it (picked at runtime),
+// falling back to a plain byte loop otherwise.
+
+// Instruction sets the scanners can use; every level gives the same results
+typedef enum {
+    SCAN_LEVEL_SCALAR,
+    SCAN_LEVEL_SSE2,
+    SCAN_LEVEL_AVX2
+} ScanLevel;
+
+// The widest level this build and CPU support
+ScanLevel scan_best_level(void);
+
+// The level in use. Picked on the first scan: the best one, or no wider than
+// the one named by the MINI_COMPILER_SCAN environment variable ("scalar", "sse2"
+// or "avx2"), so the scalar path can be forced without rebuilding.
+ScanLevel scan_level(void);
+
+// Use level, capped at scan_best_level(), from now on; for tests and benchmarks.
+// Returns the level now in use.
+ScanLevel scan_set_level(ScanLevel level);
+
+// Skip spaces, tabs and newlines starting at p.
+// Returns a pointer to the first other byte (possibly the NUL terminator).
+const char* scan_whitespace(const char* p);
+
+// Returns a pointer to the next '\n' or NUL terminator at or after p.
+const char* scan_line_end(const char* p);
+
+// Skip the body of a block comment starting at p.
+// Returns a pointer to the closing "*/" or to the NUL terminator if there is none.
+const char* scan_block_comment(const char* p);
+
+// Skip letters, digits and underscores starting at p.
+// Returns a pointer to the first other byte.
+const char* scan_identifier(const char* p);
+
+// Skip decimal digits starting at p.
+// Returns a pointer to the first other byte.
+const char* scan_digits(const char* p);
+
+// Find the newlines among the length bytes at p, which need not be NUL-terminated.
+// Stores the index of each one (relative to p) in offsets unless it is NULL.
+// Returns the number of newlines.
+size_t scan_newlines(const char* p, size_t length, uint32_t* offsets);
+
+#endif /* SCAN_H */
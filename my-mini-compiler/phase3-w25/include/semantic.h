@@ -5,10 +5,10 @@
 // =============== BEGIN STEP 1 ===============
 // Basic symbol structure
 typedef struct Symbol {
-    char name[100]; // Variable name
+    uint32_t name; // Intern ID of the variable name (see intern.h)
     int type; // Data type (int, etc.)
     int scope_level; // Scope nesting level
-    int line_declared; // Line where declared
+    int offset_declared; // Source offset of the declaration
     int is_initialized; // Has been assigned a value?
     struct Symbol *next; // For linked list implementation
 } Symbol;
@@ -27,6 +27,7 @@ typedef enum {
     SEM_ERROR_TYPE_MISMATCH,
     SEM_ERROR_UNINITIALIZED_VARIABLE,
     SEM_ERROR_INVALID_OPERATION,
+    SEM_ERROR_NUMBER_OUT_OF_RANGE,
     SEM_ERROR_SEMANTIC_ERROR  // Generic semantic error
 } SemanticErrorType;
 
@@ -35,13 +36,13 @@ typedef enum {
 SymbolTable* init_symbol_table();
 
 // Add a symbol to the table
-// Inserts a new variable with given name, type, and line number into the current scope
-void add_symbol(SymbolTable* table, const char* name, int type, int line);
+// Inserts a new variable with given name, type, and source offset into the current scope
+void add_symbol(SymbolTable* table, uint32_t name, int type, int offset);
 
 // Look up a symbol in the table
 // Searches for a variable by name across all accessible scopes
 // Returns the symbol if found, NULL otherwise
-Symbol* lookup_symbol(SymbolTable* table, const char* name);
+Symbol* lookup_symbol(SymbolTable* table, uint32_t name);
 
 // Enter a new scope level
 // Increments the current scope level when entering a block (e.g., if, while)
@@ -61,30 +62,30 @@ void remove_symbols_in_current_scope(SymbolTable* table);
 void free_symbol_table(SymbolTable* table);
 
 // Main semantic analysis function
-int analyze_semantics(ASTNode* ast);
+int analyze_semantics(CompilerContext* ctx, ASTNode* ast);
 
 // Check program node
-int check_program(ASTNode* node, SymbolTable* table);
+int check_program(CompilerContext* ctx, ASTNode* node, SymbolTable* table);
 
 // Check statement (left child)
-int check_statement(ASTNode* node, SymbolTable* table);
+int check_statement(CompilerContext* ctx, ASTNode* node, SymbolTable* table);
 
 // Check a variable declaration
-int check_declaration(ASTNode* node, SymbolTable* table);
+int check_declaration(CompilerContext* ctx, ASTNode* node, SymbolTable* table);
 
 // Check a variable assignment
-int check_assignment(ASTNode* node, SymbolTable* table);
+int check_assignment(CompilerContext* ctx, ASTNode* node, SymbolTable* table);
 
 // Check an expression for type correctness
-int check_expression(ASTNode* node, SymbolTable* table);
+int check_expression(CompilerContext* ctx, ASTNode* node, SymbolTable* table);
 
 // Check a block of statements, handling scope
-int check_block(ASTNode* node, SymbolTable* table);
+int check_block(CompilerContext* ctx, ASTNode* node, SymbolTable* table);
 
 // Check a condition (e.g., in if statements)
-int check_condition(ASTNode* node, SymbolTable* table);
+int check_condition(CompilerContext* ctx, ASTNode* node, SymbolTable* table);
 
 // Report semantic errors
-void semantic_error(SemanticErrorType error, const char* name, int line);
+void semantic_error(CompilerContext* ctx, SemanticErrorType error, const char* name, int offset);
 
 #endif //SEMANTIC_H
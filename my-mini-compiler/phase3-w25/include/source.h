@@ -0,0 +1,24 @@
+/* source.h */
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <stddef.h>
+
+// A source file mapped read-only into memory. The lexer needs a NUL-terminated
+// buffer; data[size] is always readable and '\0' without copying the file.
+typedef struct {
+    const char *data; // File contents followed by '\0'
+    size_t size; // Number of content bytes
+
+    void *mapping; // Start of the mapped region, NULL unless the file was mapped
+    size_t mapping_size;
+    char *buffer; // Heap copy for inputs that cannot be mapped, NULL otherwise
+} SourceFile;
+
+// Map the file at path ("-" reads stdin). Returns 0 on success, -1 with errno set on failure.
+int source_open(SourceFile *file, const char *path);
+
+// Unmap or free the file contents
+void source_close(SourceFile *file);
+
+#endif /* SOURCE_H */
@@ -0,0 +1,29 @@
+/* source_map.h */
+#ifndef SOURCE_MAP_H
+#define SOURCE_MAP_H
+
+#include <stdint.h>
+
+// Source map: turns byte offsets into line and column numbers. Tokens only carry
+// offsets; the index of line starts is built on the first lookup, which normally
+// means the first diagnostic, so error-free compilations never pay for it.
+typedef struct {
+    const char* source; // NUL-terminated source buffer
+    uint32_t* line_start; // Offset of the first byte of each line, NULL until built
+    uint32_t line_count;
+} SourceMap;
+
+// 1-based line and column; the column counts bytes
+typedef struct {
+    int line;
+    int column;
+} SourceLocation;
+
+// Nothing is scanned or allocated until the first source_locate()
+void source_map_init(SourceMap* map, const char* source);
+void source_map_free(SourceMap* map);
+
+// Location of the byte at offset, which may be the offset of the NUL terminator
+SourceLocation source_locate(SourceMap* map, uint32_t offset);
+
+#endif /* SOURCE_MAP_H */
@@ -0,0 +1,54 @@
+/* stream_lexer.h */
+#ifndef STREAM_LEXER_H
+#define STREAM_LEXER_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "lexer.h"
+
+#define STREAM_DEFAULT_CAPACITY (64 * 1024)
+#define STREAM_MIN_CAPACITY 16
+
+// Streaming lexer: pulls the source from a FILE* through a fixed-size window,
+// so memory use stays constant however large the input is. Tokens that straddle
+// a refill (including comments and strings) are re-lexed once more input is in.
+// The one exception to the fixed size is a string literal longer than the window:
+// the window grows to hold it, so strings come out as the whole-buffer lexer
+// produces them, and stays that size.
+// The source is gone by the time anyone could ask for a line number, so unlike
+// the whole-buffer lexer it counts lines as it goes, in bulk between tokens.
+typedef struct {
+    FILE* input;
+    char* buffer; // Current window of the stream, NUL-terminated at buffer[filled]
+    size_t capacity; // Maximum number of bytes in the window; grows for long strings
+    size_t filled; // Number of valid bytes in the window
+    size_t start; // Window index of the next unread byte
+    int64_t base; // Stream offset of buffer[0]
+    size_t counted; // Window index up to which newlines are counted
+    int64_t line; // Line number at buffer[counted]
+    int64_t line_start; // Stream offset of that line's first byte
+    int eof; // The input is exhausted
+    int failed; // Reading the input failed
+    Lexer core; // Whole-buffer lexer run over the window
+} StreamLexer;
+
+// A token from the stream. token.offset indexes lexer->buffer, so the lexeme is
+// available through token_lexeme(token, lexer->buffer, ...) until the next call.
+// Any other lexeme that does not fit in the window is cut off at the window size
+// and reported as ERROR_IDENTIFIER_TOO_LONG; the rest of it is lexed as further
+// tokens. A string that cannot be held (out of memory, or past INT_MAX bytes) is
+// cut off the same way and reported as ERROR_STRING_TOO_LONG.
+typedef struct {
+    Token token;
+    int64_t offset; // Stream offset of the lexeme
+    int64_t line; // Line number of the offset
+    int64_t column; // Byte column of the offset, 1-based
+} StreamToken;
+
+// Returns 0 on success, -1 if the window could not be allocated
+int stream_lexer_init(StreamLexer* lexer, FILE* input, size_t capacity);
+StreamToken stream_next_token(StreamLexer* lexer);
+void stream_lexer_free(StreamLexer* lexer);
+
+#endif /* STREAM_LEXER_H */
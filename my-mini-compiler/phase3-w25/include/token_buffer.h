@@ -0,0 +1,60 @@
+/* token_buffer.h */
+#ifndef TOKEN_BUFFER_H
+#define TOKEN_BUFFER_H
+
+#include <stdint.h>
+
+#include "tokens.h"
+
+// A whole token stream stored as parallel arrays, one entry per token, so a pass
+// over it touches only the fields it needs. Tokens are addressed by index.
+typedef struct {
+    uint8_t* type; // TokenType
+    uint8_t* error; // ErrorType
+    uint32_t* offset;
+    uint32_t* length;
+    uint32_t* symbol; // Intern ID of identifiers
+    uint64_t* number; // NumberValue of numbers, the bits of its integer or decimal
+    uint8_t* number_flags;
+    uint32_t count;
+    uint32_t capacity;
+} TokenBuffer;
+
+void token_buffer_init(TokenBuffer* tokens);
+void token_buffer_free(TokenBuffer* tokens);
+
+// Ensure room for at least capacity tokens. Returns 0 on success, -1 if out of memory.
+int token_buffer_reserve(TokenBuffer* tokens, uint32_t capacity);
+
+// Append a token. Returns 0 on success, -1 if out of memory.
+static inline int token_buffer_push(TokenBuffer* tokens, Token token) {
+    if (tokens->count == tokens->capacity) {
+        if (tokens->capacity > UINT32_MAX / 2) return -1;
+        if (token_buffer_reserve(tokens, tokens->capacity ? tokens->capacity * 2 : 1024) != 0) return -1;
+    }
+
+    uint32_t i = tokens->count++;
+    tokens->type[i] = (uint8_t) token.type;
+    tokens->error[i] = (uint8_t) token.error;
+    tokens->offset[i] = (uint32_t) token.offset;
+    tokens->length[i] = (uint32_t) token.length;
+    tokens->symbol[i] = token.symbol;
+    tokens->number[i] = (uint64_t) token.number.integer;
+    tokens->number_flags[i] = token.number.flags;
+    return 0;
+}
+
+// Reassemble the token at index
+static inline Token token_at(const TokenBuffer* tokens, uint32_t index) {
+    Token token = {
+        .type = (TokenType) tokens->type[index],
+        .offset = (int) tokens->offset[index],
+        .length = (int) tokens->length[index],
+        .error = (ErrorType) tokens->error[index],
+        .symbol = tokens->symbol[index],
+        .number = {.integer = (int64_t) tokens->number[index], .flags = tokens->number_flags[index]}
+    };
+    return token;
+}
+
+#endif /* TOKEN_BUFFER_H */
@@ -0,0 +1,52 @@
+/* token_dump.h */
+#ifndef TOKEN_DUMP_H
+#define TOKEN_DUMP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "token_buffer.h"
+
+// Binary token stream dumps: the lexer's output in a few bytes per token, cheap
+// to write, to cache and to compare. A dump starts with the magic "MCTK", a
+// version byte and two varints, the source size and the token count. Each token
+// follows as varints (LEB128), most of them one byte long:
+//
+//     type | error << 6
+//     offset - end of the previous token, zigzag encoded
+//     length
+//     newlines between the previous token's offset and this one's
+//     TOKEN_NUMBER only: the flags byte of its NumberValue, then the integer as
+//                        a varint or the decimal as 8 little-endian bytes
+//
+// Intern IDs are not stored; they depend on the table the tokens were lexed into.
+#define TOKEN_DUMP_MAGIC "MCTK"
+#define TOKEN_DUMP_VERSION 1
+
+// Write the tokens lexed from source as a dump. Returns 0 on success, -1 on a write error.
+int token_dump_write(FILE* out, const TokenBuffer* tokens, const char* source);
+
+// Reads a dump in place, e.g. straight out of a mapped file
+typedef struct {
+    const uint8_t* next; // Next unread byte
+    const uint8_t* end;
+    uint64_t source_size;
+    uint32_t count; // Number of tokens in the dump
+    uint32_t index; // Number of tokens read so far
+    uint64_t previous_end; // End of the previous token
+    uint64_t line; // Line of the previous token
+} TokenDumpReader;
+
+// Returns 0 on success, -1 if data does not start with a dump header of this version
+int token_dump_open(TokenDumpReader* reader, const void* data, size_t size);
+
+// Read the next token and its 1-based line. Returns 1 if a token was read, 0 after
+// the last one, -1 if the dump is truncated or corrupt.
+int token_dump_next(TokenDumpReader* reader, Token* token, uint64_t* line);
+
+// Read a whole dump into tokens. Returns 0 on success, -1 if the dump is corrupt
+// or the buffer ran out of memory.
+int token_dump_load(const void* data, size_t size, TokenBuffer* tokens);
+
+#endif /* TOKEN_DUMP_H */
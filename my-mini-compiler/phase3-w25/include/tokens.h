@@ -2,6 +2,8 @@
 #ifndef TOKENS_H
 #define TOKENS_H
 
+#include <stdint.h>
+
 typedef enum {
     TOKEN_EOF,
     TOKEN_NUMBER, // e.g., "123", "456"
@@ -51,14 +53,35 @@ typedef enum {
     ERROR_IDENTIFIER_TOO_LONG,     // identifier length exceeds limit                                           unimplemented
     ERROR_INVALID_IDENTIFIER,      // Identifier starting with a number or containing invalid characters        unimplemented
     ERROR_INVALID_OPERATOR,
-    ERROR_UNEXPECTED_TOKEN
+    ERROR_UNEXPECTED_TOKEN,
+    ERROR_STRING_TOO_LONG          // string literal too long to hold in memory
 } ErrorType;
 
+// Flags of a NumberValue
+enum {
+    NUMBER_DECIMAL = 1, // Written with a '.', the value is in `decimal`
+    NUMBER_OVERFLOW = 2 // Out of range: integers saturate at INT64_MAX, decimals are infinite
+};
+
+// Value of a numeric literal, converted while lexing
+typedef struct {
+    union {
+        int64_t integer;
+        double decimal;
+    };
+    uint8_t flags;
+} NumberValue;
+
+// A token is a view into the source buffer it was lexed from; the lexeme text
+// is only materialized on demand (see token_lexeme() in lexer.h) and the line
+// and column are looked up from the offset (see source_map.h)
 typedef struct {
     TokenType type;
-    char lexeme[100]; // Actual text of the token
-    int line; // Line number in source file
+    int offset; // Index of the first lexeme byte in the source buffer
+    int length; // Number of lexeme bytes
     ErrorType error; // Error type if any
+    uint32_t symbol; // Intern ID of an identifier's name when the lexer interns, else 0
+    NumberValue number; // Value of a TOKEN_NUMBER without ERROR_INVALID_NUMBER, else 0
 } Token;
 
 #endif /* TOKENS_H */
\ No newline at end of file
@@ -0,0 +1,24 @@
+/* utf8.h */
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Check that the length bytes at p are well-formed UTF-8: no stray continuation
+// bytes, truncated, overlong or surrogate sequences, nothing past U+10FFFF. Uses
+// AVX2 where the CPU supports it. Returns length if they are, else the offset of
+// the first byte that does not start a valid character.
+size_t utf8_validate(const char* p, size_t length);
+
+// Decode the character at p into *code_point. Returns its length in bytes (1 to 4),
+// or 0 if p does not start a well-formed sequence. Stops at the first byte that
+// is not a continuation byte, so it never reads past a NUL terminator.
+int utf8_decode(const char* p, uint32_t* code_point);
+
+// Unicode identifier properties: characters that may start an identifier and
+// characters that may continue one (UAX #31)
+int unicode_is_xid_start(uint32_t code_point);
+int unicode_is_xid_continue(uint32_t code_point);
+
+#endif /* UTF8_H */
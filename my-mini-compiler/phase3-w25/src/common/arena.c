@@ -0,0 +1,42 @@
+/* arena.c */
+#include <stdlib.h>
+
+#include "../../include/arena.h"
+
+struct ArenaChunk {
+    ArenaChunk* previous;
+    _Alignas(max_align_t) char data[]; // The chunk's memory
+};
+
+void arena_init(Arena *arena) {
+    arena->chunk = NULL;
+    arena->next = NULL;
+    arena->left = 0;
+    arena->chunk_size = 0;
+}
+
+void arena_free(Arena *arena) {
+    ArenaChunk *chunk = arena->chunk;
+    while (chunk) {
+        ArenaChunk *previous = chunk->previous;
+        free(chunk);
+        chunk = previous;
+    }
+    arena_init(arena);
+}
+
+void *arena_alloc_slow(Arena *arena, size_t size) {
+    size_t chunk_size = arena->chunk_size ? arena->chunk_size * 2 : ARENA_FIRST_CHUNK;
+    if (chunk_size > ARENA_MAX_CHUNK) chunk_size = ARENA_MAX_CHUNK;
+    if (chunk_size < size) chunk_size = size; // A large allocation gets a chunk of its own
+    if (chunk_size > SIZE_MAX - sizeof(ArenaChunk)) return NULL;
+
+    ArenaChunk *chunk = malloc(sizeof(ArenaChunk) + chunk_size);
+    if (!chunk) return NULL;
+    chunk->previous = arena->chunk;
+    arena->chunk = chunk;
+    arena->chunk_size = chunk_size;
+    arena->next = chunk->data + size;
+    arena->left = chunk_size - size;
+    return chunk->data;
+}
@@ -0,0 +1,99 @@
+/* intern.c */
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/intern.h"
+
+// FNV-1a
+static uint32_t hash_name(const char *name, uint32_t length) {
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < length; i++) {
+        hash ^= (unsigned char) name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void intern_init(InternTable *table) {
+    memset(table, 0, sizeof(*table));
+}
+
+void intern_free(InternTable *table) {
+    free(table->bytes);
+    free(table->name_offset);
+    free(table->name_length);
+    free(table->name_hash);
+    free(table->slots);
+    intern_init(table);
+}
+
+// Double the slot array and re-insert every ID
+static int grow_slots(InternTable *table) {
+    uint32_t slot_count = table->slots ? (table->slot_mask + 1) * 2 : 256;
+    uint32_t *slots = calloc(slot_count, sizeof(*slots));
+    if (!slots) return -1;
+
+    uint32_t mask = slot_count - 1;
+    for (uint32_t id = 1; id <= table->count; id++) {
+        uint32_t i = table->name_hash[id] & mask;
+        while (slots[i]) i = (i + 1) & mask;
+        slots[i] = id;
+    }
+
+    free(table->slots);
+    table->slots = slots;
+    table->slot_mask = mask;
+    return 0;
+}
+
+// Make room for one more ID and length more name bytes
+static int reserve(InternTable *table, uint32_t length) {
+    if (table->count + 1 >= table->capacity) {
+        uint32_t capacity = table->capacity ? table->capacity * 2 : 256;
+        uint32_t *offset = realloc(table->name_offset, capacity * sizeof(*offset));
+        if (!offset) return -1;
+        table->name_offset = offset;
+        uint32_t *lengths = realloc(table->name_length, capacity * sizeof(*lengths));
+        if (!lengths) return -1;
+        table->name_length = lengths;
+        uint32_t *hashes = realloc(table->name_hash, capacity * sizeof(*hashes));
+        if (!hashes) return -1;
+        table->name_hash = hashes;
+        table->capacity = capacity;
+    }
+
+    if (table->bytes_used + length + 1 > table->bytes_capacity) {
+        uint32_t capacity = table->bytes_capacity ? table->bytes_capacity : 4096;
+        while (table->bytes_used + length + 1 > capacity) capacity *= 2;
+        char *bytes = realloc(table->bytes, capacity);
+        if (!bytes) return -1;
+        table->bytes = bytes;
+        table->bytes_capacity = capacity;
+    }
+    return 0;
+}
+
+uint32_t intern(InternTable *table, const char *name, uint32_t length) {
+    // Keep the load factor at or below one half
+    if ((table->count + 1) * 2 > (table->slots ? table->slot_mask + 1 : 0) && grow_slots(table) != 0) return 0;
+
+    uint32_t hash = hash_name(name, length);
+    uint32_t i = hash & table->slot_mask;
+    for (uint32_t id; (id = table->slots[i]) != 0; i = (i + 1) & table->slot_mask) {
+        if (table->name_hash[id] == hash && table->name_length[id] == length &&
+            memcmp(table->bytes + table->name_offset[id], name, length) == 0) {
+            return id;
+        }
+    }
+
+    if (reserve(table, length) != 0) return 0;
+    uint32_t id = ++table->count;
+    table->name_offset[id] = table->bytes_used;
+    table->name_length[id] = length;
+    table->name_hash[id] = hash;
+    memcpy(table->bytes + table->bytes_used, name, length);
+    table->bytes[table->bytes_used + length] = '\0';
+    table->bytes_used += length + 1;
+    table->slots[i] = id;
+    return id;
+}
@@ -0,0 +1,63 @@
+/* source_map.c */
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/source_map.h"
+#include "../../include/scan.h"
+
+void source_map_init(SourceMap *map, const char *source) {
+    map->source = source;
+    map->line_start = NULL;
+    map->line_count = 0;
+}
+
+void source_map_free(SourceMap *map) {
+    free(map->line_start);
+    source_map_init(map, map->source);
+}
+
+// Index every line start: one vector pass counts the newlines, a second records them
+static int build(SourceMap *map) {
+    size_t length = strlen(map->source);
+    size_t newlines = scan_newlines(map->source, length, NULL);
+
+    uint32_t *line_start = malloc(sizeof(*line_start) * (newlines + 1));
+    if (!line_start) return -1;
+
+    line_start[0] = 0;
+    scan_newlines(map->source, length, line_start + 1);
+    for (size_t i = 1; i <= newlines; i++) line_start[i]++;
+
+    map->line_start = line_start;
+    map->line_count = (uint32_t) (newlines + 1);
+    return 0;
+}
+
+SourceLocation source_locate(SourceMap *map, uint32_t offset) {
+    SourceLocation location;
+
+    if (!map->line_start && build(map) != 0) {
+        // Out of memory: count the lines up to the offset instead
+        uint32_t start = offset;
+        while (start > 0 && map->source[start - 1] != '\n') start--;
+        location.line = (int) scan_newlines(map->source, offset, NULL) + 1;
+        location.column = (int) (offset - start) + 1;
+        return location;
+    }
+
+    // Last line starting at or before the offset
+    uint32_t low = 0;
+    uint32_t high = map->line_count;
+    while (high - low > 1) {
+        uint32_t middle = low + (high - low) / 2;
+        if (map->line_start[middle] <= offset) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+
+    location.line = (int) low + 1;
+    location.column = (int) (offset - map->line_start[low]) + 1;
+    return location;
+}
@@ -0,0 +1,253 @@
+/* utf8.c */
+#include <string.h>
+
+#include "../../include/unicode_tables.h"
+#include "../../include/utf8.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define UTF8_X86 1
+#include <immintrin.h>
+#else
+#define UTF8_X86 0
+#endif
+
+int utf8_decode(const char *p, uint32_t *code_point) {
+    const unsigned char *s = (const unsigned char *) p;
+    uint32_t c;
+
+    if (s[0] < 0x80) {
+        *code_point = s[0];
+        return 1;
+    }
+    if (s[0] < 0xC2) return 0; // Continuation byte, or the lead of an overlong pair
+
+    if (s[0] < 0xE0) {
+        if ((s[1] & 0xC0) != 0x80) return 0;
+        *code_point = (uint32_t) (s[0] & 0x1F) << 6 | (s[1] & 0x3F);
+        return 2;
+    }
+    if (s[0] < 0xF0) {
+        if ((s[1] & 0xC0) != 0x80 || (s[2] & 0xC0) != 0x80) return 0;
+        c = (uint32_t) (s[0] & 0x0F) << 12 | (uint32_t) (s[1] & 0x3F) << 6 | (s[2] & 0x3F);
+        if (c < 0x800 || (c >= 0xD800 && c <= 0xDFFF)) return 0; // Overlong or a surrogate
+        *code_point = c;
+        return 3;
+    }
+    if (s[0] < 0xF5) {
+        if ((s[1] & 0xC0) != 0x80 || (s[2] & 0xC0) != 0x80 || (s[3] & 0xC0) != 0x80) return 0;
+        c = (uint32_t) (s[0] & 0x07) << 18 | (uint32_t) (s[1] & 0x3F) << 12 | (uint32_t) (s[2] & 0x3F) << 6 |
+            (s[3] & 0x3F);
+        if (c < 0x10000 || c > 0x10FFFF) return 0;
+        *code_point = c;
+        return 4;
+    }
+    return 0;
+}
+
+// =============== Scalar validation ===============
+
+static size_t validate_scalar(const char *p, size_t length) {
+    size_t i = 0;
+    while (i < length) {
+        // ASCII eight bytes at a time
+        if (length - i >= 8) {
+            uint64_t word;
+            memcpy(&word, p + i, sizeof(word));
+            if (!(word & 0x8080808080808080u)) {
+                i += 8;
+                continue;
+            }
+        }
+        if ((unsigned char) p[i] < 0x80) {
+            i++;
+            continue;
+        }
+
+        // Near the end, decode from a zero-padded copy so the sequence cannot run past length
+        uint32_t code_point;
+        int n;
+        if (length - i < 4) {
+            char tail[4] = {0};
+            memcpy(tail, p + i, length - i);
+            n = utf8_decode(tail, &code_point);
+        } else {
+            n = utf8_decode(p + i, &code_point);
+        }
+        if (n == 0) return i;
+        i += (size_t) n;
+    }
+    return length;
+}
+
+#if UTF8_X86
+
+// =============== AVX2, 32 bytes per step ===============
+// The lookup algorithm of Keiser and Lemire ("Validating UTF-8 in less than one
+// instruction per byte", 2021). Every pair of adjacent bytes is classified by three
+// 16-entry table lookups, on the high and low nibble of the first byte and the high
+// nibble of the second; ANDing the results leaves a bit set exactly for the error
+// kinds both bytes agree on. Third and fourth bytes of a sequence are checked by
+// looking two and three bytes back for a lead byte that requires them.
+
+#define TOO_SHORT (1 << 0) // Lead byte not followed by a continuation byte
+#define TOO_LONG (1 << 1) // Continuation byte after an ASCII byte
+#define OVERLONG_3 (1 << 2)
+#define TOO_LARGE (1 << 3)
+#define SURROGATE (1 << 4)
+#define OVERLONG_2 (1 << 5)
+#define TOO_LARGE_1000 (1 << 6)
+#define OVERLONG_4 (1 << 6)
+#define TWO_CONTS (1 << 7) // Two continuation bytes in a row: fine only inside a long sequence
+#define CARRY (TOO_SHORT | TOO_LONG | TWO_CONTS)
+
+// Input shifted back by n bytes, the first n taken from the end of the previous block
+#define PREVIOUS_BYTES(input, previous, n) \
+    _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - (n))
+
+typedef struct {
+    __m256i previous; // Previous block
+    __m256i error; // Any bit set: invalid
+    __m256i incomplete; // The previous block ended inside a sequence
+} Utf8State;
+
+__attribute__((target("avx2")))
+static inline __m256i high_nibbles(__m256i bytes) {
+    return _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi8(0x0F));
+}
+
+__attribute__((target("avx2")))
+static inline void validate_block(Utf8State *state, __m256i input) {
+    if (_mm256_movemask_epi8(input) == 0) {
+        // All ASCII: only a sequence left open by the previous block can be wrong
+        state->error = _mm256_or_si256(state->error, state->incomplete);
+        state->incomplete = _mm256_setzero_si256();
+        state->previous = input;
+        return;
+    }
+
+    const __m256i byte_1_high_table = _mm256_setr_epi8(
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+        TOO_SHORT | OVERLONG_2,
+        TOO_SHORT,
+        TOO_SHORT | OVERLONG_3 | SURROGATE,
+        TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4,
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+        TOO_SHORT | OVERLONG_2,
+        TOO_SHORT,
+        TOO_SHORT | OVERLONG_3 | SURROGATE,
+        TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4);
+    const __m256i byte_1_low_table = _mm256_setr_epi8(
+        CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+        CARRY | OVERLONG_2,
+        CARRY, CARRY,
+        CARRY | TOO_LARGE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+        CARRY | OVERLONG_2,
+        CARRY, CARRY,
+        CARRY | TOO_LARGE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000);
+    const __m256i byte_2_high_table = _mm256_setr_epi8(
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT);
+
+    __m256i previous_1 = PREVIOUS_BYTES(input, state->previous, 1);
+    __m256i special_cases = _mm256_and_si256(
+        _mm256_and_si256(_mm256_shuffle_epi8(byte_1_high_table, high_nibbles(previous_1)),
+                         _mm256_shuffle_epi8(byte_1_low_table, _mm256_and_si256(previous_1, _mm256_set1_epi8(0x0F)))),
+        _mm256_shuffle_epi8(byte_2_high_table, high_nibbles(input)));
+
+    // Bytes two after a three or four byte lead, or three after a four byte lead,
+    // must be continuation bytes; only those may (and must) carry TWO_CONTS
+    __m256i previous_2 = PREVIOUS_BYTES(input, state->previous, 2);
+    __m256i previous_3 = PREVIOUS_BYTES(input, state->previous, 3);
+    __m256i must_continue = _mm256_or_si256(_mm256_subs_epu8(previous_2, _mm256_set1_epi8((char) (0xE0 - 0x80))),
+                                            _mm256_subs_epu8(previous_3, _mm256_set1_epi8((char) (0xF0 - 0x80))));
+    must_continue = _mm256_and_si256(must_continue, _mm256_set1_epi8((char) 0x80));
+    state->error = _mm256_or_si256(state->error, _mm256_xor_si256(must_continue, special_cases));
+
+    // A lead byte among the last three that needs more bytes than are left
+    const __m256i max_complete = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        (char) (0xF0 - 1), (char) (0xE0 - 1), (char) (0xC0 - 1));
+    state->incomplete = _mm256_subs_epu8(input, max_complete);
+    state->previous = input;
+}
+
+__attribute__((target("avx2")))
+static int valid_avx2(const char *p, size_t length) {
+    Utf8State state = {_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+    size_t i = 0;
+    for (; length - i >= 32; i += 32) {
+        validate_block(&state, _mm256_loadu_si256((const __m256i *) (p + i)));
+    }
+    if (i < length) {
+        // The zeros after the tail are ASCII, which any open sequence fails against
+        char tail[32] = {0};
+        memcpy(tail, p + i, length - i);
+        validate_block(&state, _mm256_loadu_si256((const __m256i *) tail));
+    }
+    __m256i error = _mm256_or_si256(state.error, state.incomplete);
+    return _mm256_testz_si256(error, error);
+}
+
+#endif /* UTF8_X86 */
+
+size_t utf8_validate(const char *p, size_t length) {
+#if UTF8_X86
+    // The vector pass only tells whether there is an error; find it the slow way
+    if (__builtin_cpu_supports("avx2") && valid_avx2(p, length)) return length;
+#endif
+    return validate_scalar(p, length);
+}
+
+// =============== Identifier properties ===============
+
+static int in_ranges(const UnicodeRange *ranges, size_t count, uint32_t code_point) {
+    size_t low = 0;
+    size_t high = count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (ranges[middle].last < code_point) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low < count && ranges[low].first <= code_point;
+}
+
+int unicode_is_xid_start(uint32_t code_point) {
+    if (code_point < 0x80) return (unsigned) ((code_point | 0x20) - 'a') < 26;
+    return in_ranges(xid_start_ranges, sizeof(xid_start_ranges) / sizeof(xid_start_ranges[0]), code_point);
+}
+
+int unicode_is_xid_continue(uint32_t code_point) {
+    if (code_point < 0x80) {
+        return (unsigned) ((code_point | 0x20) - 'a') < 26 || (unsigned) (code_point - '0') < 10 || code_point == '_';
+    }
+    return in_ranges(xid_continue_ranges, sizeof(xid_continue_ranges) / sizeof(xid_continue_ranges[0]), code_point);
+}
@@ -0,0 +1,46 @@
+/* context.c */
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/context.h"
+#include "../../include/pipelined_lexer.h"
+
+void context_init(CompilerContext *ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+    lexer_init(&ctx->lexer, "");
+    ctx->parser.max_depth = PARSER_MAX_DEPTH;
+}
+
+void context_free(CompilerContext *ctx) {
+    if (ctx->parser.pipeline) lex_pipeline_finish(ctx->parser.pipeline);
+    ctx->parser.pipeline = NULL;
+    token_buffer_free(&ctx->parser.tokens);
+    free(ctx->parser.items);
+    ctx->parser.items = NULL;
+    ctx->parser.item_count = ctx->parser.item_capacity = 0;
+    arena_free(&ctx->ast);
+    intern_free(&ctx->interns);
+    source_map_free(&ctx->source_map);
+}
+
+void context_set_diagnostic_handler(CompilerContext *ctx, DiagnosticHandler handler, void *user_data) {
+    ctx->diagnostics.handler = handler;
+    ctx->diagnostics.user_data = user_data;
+}
+
+void report_diagnostic(CompilerContext *ctx, const char *format, ...) {
+    char message[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    ctx->diagnostics.error_count++;
+    if (ctx->diagnostics.handler) {
+        ctx->diagnostics.handler(ctx->diagnostics.user_data, message);
+    } else {
+        printf("%s\n", message);
+    }
+}
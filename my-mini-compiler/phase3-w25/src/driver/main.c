@@ -0,0 +1,184 @@
+/* main.c */
+// Compiler driver: my-mini-compiler [--tokens | --pipeline] [source file | -]
+//                  my-mini-compiler --dump-tokens <source file | -> <dump file>
+// The source file is memory mapped and lexed in place; without an argument the
+// built-in sample program is compiled instead. --tokens only lexes, streaming the
+// input through a fixed-size window so inputs of any size can be tokenized.
+// --pipeline lexes on a thread of its own while the parser consumes the tokens.
+// --dump-tokens lexes the whole input and writes the tokens as a binary dump
+// (see token_dump.h; tools/token_dump_text.c turns one back into --tokens output).
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../../include/parser.h"
+#include "../../include/semantic.h"
+#include "../../include/source.h"
+#include "../../include/stream_lexer.h"
+#include "../../include/token_dump.h"
+#include "../../include/utf8.h"
+
+static const char *sample_input =
+        "x = 42;\n"
+        "if (x > y) {\n"
+        "    int y;\n"
+        "    y = z + 10;\n"
+        "    print y;\n"
+        "}\n";
+
+// const char *sample_input =
+//         "// Uninitialized variable\n"
+//         "int x;\n"
+//         "int y;\n"
+//         "y = x + 5; // Warning: x used before initialization\n";
+//"print y;";
+
+// const char *sample_input = "int x;\n"
+//         "x = 42;\n"
+//         "y = 45;\n";
+
+// Print every token of the input without keeping more than one window of it in memory
+static int stream_tokens(const char *path) {
+    FILE *input = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+    if (!input) {
+        perror(path);
+        return 2;
+    }
+
+    StreamLexer lexer;
+    if (stream_lexer_init(&lexer, input, STREAM_DEFAULT_CAPACITY) != 0) {
+        perror(path);
+        if (input != stdin) fclose(input);
+        return 2;
+    }
+
+    StreamToken token;
+    do {
+        token = stream_next_token(&lexer);
+        SourceLocation location = {
+            token.line < INT_MAX ? (int) token.line : INT_MAX,
+            token.column < INT_MAX ? (int) token.column : INT_MAX
+        };
+        print_token(token.token, lexer.buffer, location);
+    } while (token.token.type != TOKEN_EOF);
+
+    int failed = lexer.failed;
+    if (failed) fprintf(stderr, "%s: read error\n", path);
+    stream_lexer_free(&lexer);
+    if (input != stdin) fclose(input);
+    return failed ? 2 : 0;
+}
+
+// Lex the whole input and write its tokens as a binary dump
+static int dump_tokens(const char *path, const char *dump_path) {
+    SourceFile file;
+    if (source_open(&file, path) != 0) {
+        perror(path);
+        return 2;
+    }
+    FILE *out = fopen(dump_path, "wb");
+    if (!out) {
+        perror(dump_path);
+        source_close(&file);
+        return 2;
+    }
+
+    Lexer lexer;
+    TokenBuffer tokens;
+    lexer_init(&lexer, file.data);
+    token_buffer_init(&tokens);
+    int status = 0;
+    if (lex_all(&lexer, &tokens) != 0) {
+        fprintf(stderr, "%s: out of memory\n", path);
+        status = 2;
+    } else if (token_dump_write(out, &tokens, file.data) != 0) {
+        perror(dump_path);
+        status = 2;
+    }
+
+    token_buffer_free(&tokens);
+    if (fclose(out) != 0 && status == 0) {
+        perror(dump_path);
+        status = 2;
+    }
+    source_close(&file);
+    return status;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 3 && strcmp(argv[1], "--tokens") == 0) return stream_tokens(argv[2]);
+    if (argc == 4 && strcmp(argv[1], "--dump-tokens") == 0) return dump_tokens(argv[2], argv[3]);
+    int pipelined = argc == 3 && strcmp(argv[1], "--pipeline") == 0;
+    if (pipelined) {
+        argv[1] = argv[0];
+        argv++;
+        argc--;
+    }
+    if (argc > 2 || (argc == 2 && (strcmp(argv[1], "--tokens") == 0 || strcmp(argv[1], "--dump-tokens") == 0 ||
+                                   strcmp(argv[1], "--pipeline") == 0))) {
+        fprintf(stderr, "usage: %s [--tokens | --pipeline] [source file | -]\n", argv[0]);
+        fprintf(stderr, "       %s --dump-tokens <source file | -> <dump file>\n", argv[0]);
+        return 2;
+    }
+
+    SourceFile file = {0};
+    const char *input = sample_input;
+    if (argc == 2) {
+        if (source_open(&file, argv[1]) != 0) {
+            perror(argv[1]);
+            return 2;
+        }
+        input = file.data;
+        printf("Analyzing %s (%zu bytes)\n", argv[1], file.size);
+    } else {
+        printf("Analyzing input:\n%s\n", input);
+    }
+
+    // Reject malformed UTF-8 up front, in one pass over the whole input, before
+    // any of it is lexed
+    size_t length = argc == 2 ? file.size : strlen(input);
+    size_t invalid = utf8_validate(input, length);
+    if (invalid < length) {
+        SourceMap map;
+        source_map_init(&map, input);
+        SourceLocation location = source_locate(&map, (uint32_t) invalid);
+        printf("Encoding Error at line %d, column %d: invalid UTF-8\n", location.line, location.column);
+        source_map_free(&map);
+        source_close(&file);
+        return 1;
+    }
+
+    // Lexical analysis and parsing
+    CompilerContext ctx;
+    context_init(&ctx);
+    if (pipelined) {
+        parser_init_pipelined(&ctx, input);
+    } else {
+        parser_init(&ctx, input);
+    }
+
+    ASTNode *ast = parse(&ctx);
+
+    printf("\nAbstract Syntax Tree:\n");
+    print_ast(&ctx, ast, 0);
+
+    printf("AST created. Performing semantic analysis...\n\n");
+
+    // Semantic analysis
+    int result = analyze_semantics(&ctx, ast);
+
+    if (result) {
+        printf("Semantic analysis successful. No errors found.\n");
+    } else {
+        printf("Semantic analysis failed. Errors detected.\n");
+    }
+
+    // Fail on any error reported, parse errors included, not only on semantic ones
+    int failed = !result || ctx.diagnostics.error_count > 0;
+
+    // Clean up; the AST (in the context's arena) references the source, so it goes first
+    context_free(&ctx);
+    source_close(&file);
+
+    return failed ? 1 : 0;
+}
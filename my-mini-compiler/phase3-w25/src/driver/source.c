@@ -0,0 +1,154 @@
+/* source.c */
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/source.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SOURCE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define SOURCE_MMAP 0
+#endif
+
+// Fallback for inputs that cannot be mapped (pipes, stdin, platforms without mmap):
+// read everything into a heap buffer with room for the terminator
+static int read_stream(SourceFile *file, FILE *stream) {
+    size_t capacity = 1 << 16;
+    size_t size = 0;
+    char *buffer = malloc(capacity);
+    if (!buffer) return -1;
+
+    for (;;) {
+        size += fread(buffer + size, 1, capacity - size - 1, stream);
+        if (size < capacity - 1) break;
+        char *grown = realloc(buffer, capacity * 2);
+        if (!grown) {
+            free(buffer);
+            errno = ENOMEM;
+            return -1;
+        }
+        buffer = grown;
+        capacity *= 2;
+    }
+    if (ferror(stream)) {
+        free(buffer);
+        errno = EIO;
+        return -1;
+    }
+
+    buffer[size] = '\0';
+    file->buffer = buffer;
+    file->data = buffer;
+    file->size = size;
+    return 0;
+}
+
+#if SOURCE_MMAP
+
+// Map size bytes of fd so that data[size] is a readable '\0'. Past the end of
+// the file the last page is zero filled, so only a file that ends exactly on a
+// page boundary needs help: reserve one extra zero page behind it first and map
+// the file over the front of that reservation.
+static int map_file(SourceFile *file, int fd, size_t size) {
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    size_t length = size;
+    void *base;
+
+    if (size % page == 0) {
+        length = size + page;
+        base = mmap(NULL, length, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) return -1;
+        if (mmap(base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+            int saved = errno;
+            munmap(base, length);
+            errno = saved;
+            return -1;
+        }
+    } else {
+        base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED) return -1;
+    }
+
+#ifdef MADV_SEQUENTIAL
+    madvise(base, length, MADV_SEQUENTIAL);
+#endif
+    file->data = base;
+    file->size = size;
+    file->mapping = base;
+    file->mapping_size = length;
+    return 0;
+}
+
+#endif /* SOURCE_MMAP */
+
+int source_open(SourceFile *file, const char *path) {
+    memset(file, 0, sizeof(*file));
+
+    if (strcmp(path, "-") == 0) return read_stream(file, stdin);
+
+#if SOURCE_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+
+    int status;
+    if (!S_ISREG(st.st_mode)) {
+        FILE *stream = fdopen(fd, "rb");
+        if (!stream) {
+            close(fd);
+            return -1;
+        }
+        status = read_stream(file, stream);
+        fclose(stream);
+        return status;
+    }
+
+    // Token offsets are ints
+    if (st.st_size > INT_MAX) {
+        close(fd);
+        errno = EFBIG;
+        return -1;
+    }
+
+    if (st.st_size == 0) {
+        file->data = "";
+        status = 0;
+    } else {
+        status = map_file(file, fd, (size_t) st.st_size);
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    int saved = errno;
+    close(fd);
+    errno = saved;
+    return status;
+#else
+    FILE *stream = fopen(path, "rb");
+    if (!stream) return -1;
+    int status = read_stream(file, stream);
+    fclose(stream);
+    return status;
+#endif
+}
+
+void source_close(SourceFile *file) {
+#if SOURCE_MMAP
+    if (file->mapping) munmap(file->mapping, file->mapping_size);
+#endif
+    free(file->buffer);
+    memset(file, 0, sizeof(*file));
+}
@@ -0,0 +1,150 @@
+/* incremental_lexer.c */
+// Incremental re-lexing. What the lexer produces from some point on depends only
+// on where it stands and on whether it has seen an arithmetic operator. Lexing can
+// therefore restart at the start of any old token whose predecessors did not look
+// into the edit, with the operator state of the tokens before it, and can stop as
+// soon as the new lexer begins a token exactly where the old one began one past
+// the edit, in the same operator state: from there on the new stream is the old
+// one, moved by the edit's length change.
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/incremental_lexer.h"
+
+// How far past its end a token may have looked: the byte that ended it, plus the
+// rest of a UTF-8 character starting there
+#define LOOKAHEAD 4
+
+static int is_operator(uint8_t type) {
+    return type == TOKEN_PLUS || type == TOKEN_MINUS || type == TOKEN_STAR || type == TOKEN_SLASH;
+}
+
+// String and char literals point past their opening quote
+static int is_quoted_error(uint8_t error) {
+    return error == ERROR_UNTERMINATED_STRING || error == ERROR_CHAR_TOO_LONG;
+}
+
+// Where the lexer began the lexeme of a token from the old stream, or -1 if the token
+// alone does not tell: a six-byte TOKEN_STRING is either the `string` keyword or a literal
+static int64_t lexeme_start(const TokenBuffer *tokens, uint32_t i) {
+    int64_t offset = tokens->offset[i];
+    if (is_quoted_error(tokens->error[i])) return offset - 1;
+    if (tokens->type[i] == TOKEN_STRING) return tokens->length[i] == 6 ? -1 : offset - 1;
+    return offset;
+}
+
+// Copy count tokens from src[from] to dst[to], adding shift to their offsets. The
+// ranges may overlap. For a large file this is most of the work of an edit, so the
+// offsets are moved and shifted in the same pass.
+static void move_tokens(TokenBuffer *dst, uint32_t to, const TokenBuffer *src, uint32_t from, uint32_t count,
+                        uint32_t shift) {
+    if (count == 0) return;
+    if (dst != src || to != from) {
+        memmove(dst->type + to, src->type + from, count * sizeof(*dst->type));
+        memmove(dst->error + to, src->error + from, count * sizeof(*dst->error));
+        memmove(dst->length + to, src->length + from, count * sizeof(*dst->length));
+        memmove(dst->symbol + to, src->symbol + from, count * sizeof(*dst->symbol));
+        memmove(dst->number + to, src->number + from, count * sizeof(*dst->number));
+        memmove(dst->number_flags + to, src->number_flags + from, count * sizeof(*dst->number_flags));
+    } else if (shift == 0) {
+        return; // Tokens stay where they are
+    }
+
+    uint32_t *out = dst->offset + to;
+    const uint32_t *in = src->offset + from;
+    if (out <= in) {
+        for (uint32_t i = 0; i < count; i++) out[i] = in[i] + shift;
+    } else {
+        for (uint32_t i = count; i-- > 0;) out[i] = in[i] + shift;
+    }
+}
+
+int lex_edit(Lexer *lexer, TokenBuffer *tokens, const LexEdit *edit, TokenRange *changed) {
+    int64_t shift = (int64_t) edit->inserted - (int64_t) edit->removed;
+    int64_t edit_end = (int64_t) edit->offset + edit->removed; // In the old source
+
+    // Restart at the last token beginning at least LOOKAHEAD bytes before the edit
+    // whose start is known; the lexer never looks back, so nothing before that token
+    // can have changed
+    uint32_t low = 0;
+    uint32_t high = tokens->count;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        if ((uint64_t) tokens->offset[middle] + LOOKAHEAD <= edit->offset) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    uint32_t first = low;
+    int64_t start = 0;
+    while (first > 0) {
+        start = lexeme_start(tokens, --first);
+        if (start >= 0) break;
+    }
+    if (start < 0) start = 0;
+
+    lexer->position = (int) start;
+    lexer->last_token_type = 'x';
+    for (uint32_t i = 0; i < first; i++) {
+        if (is_operator(tokens->type[i])) {
+            lexer->last_token_type = 'o';
+            break;
+        }
+    }
+
+    TokenBuffer fresh;
+    token_buffer_init(&fresh);
+    uint32_t old = first; // First old token that may still line up with the new stream
+    char old_state = lexer->last_token_type; // Old lexer's operator state before tokens[old]
+    int status = 0;
+
+    for (;;) {
+        char state = lexer->last_token_type;
+        Token token = get_next_token(lexer);
+        if (token.type == TOKEN_IDENTIFIER && lexer->interns && token.symbol == 0) {
+            status = -1;
+            break;
+        }
+
+        // A literal's lexer position lands past its closing quote, the keyword's does not
+        int quoted = is_quoted_error((uint8_t) token.error) ||
+                     (token.type == TOKEN_STRING && lexer->position == token.offset + token.length + 1);
+        int64_t new_start = token.offset - quoted;
+
+        while (old < tokens->count && tokens->offset[old] + shift < new_start) {
+            if (is_operator(tokens->type[old])) old_state = 'o';
+            old++;
+        }
+        if (old < tokens->count && old_state == state) {
+            int64_t old_start = lexeme_start(tokens, old);
+            if (old_start >= edit_end && old_start + shift == new_start) break; // Back in step
+        }
+
+        if (token_buffer_push(&fresh, token) != 0) {
+            status = -1;
+            break;
+        }
+        if (token.type == TOKEN_EOF) {
+            old = tokens->count;
+            break;
+        }
+    }
+
+    uint32_t kept = tokens->count - old;
+    if (status == 0) status = token_buffer_reserve(tokens, first + fresh.count + kept);
+
+    if (status == 0) {
+        uint32_t tail = first + fresh.count;
+        move_tokens(tokens, tail, tokens, old, kept, (uint32_t) shift);
+        move_tokens(tokens, first, &fresh, 0, fresh.count, 0);
+        tokens->count = tail + kept;
+
+        changed->first = first;
+        changed->old_end = old;
+        changed->new_end = tail;
+    }
+
+    token_buffer_free(&fresh);
+    return status;
+}
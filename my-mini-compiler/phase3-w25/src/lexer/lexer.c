@@ -1,42 +1,47 @@
 /* lexer.c */
 #include <stdio.h>
-#include <ctype.h>
 #include <string.h>
 
 #include "../../include/lexer.h"
+#include "../../include/lexer_tables.h"
+#include "../../include/number.h"
+#include "../../include/scan.h"
+#include "../../include/utf8.h"
+#include "keywords.h" // Generated from keywords.def
+
+#ifdef LEXER_COUNT_KEYWORD_LOOKUPS
+// Test builds count keyword lookups, so the identifier rules can be checked to do a
+// bounded number per identifier without timing anything
+unsigned long lexer_keyword_lookups;
+#define keyword_lookup(word, length) (lexer_keyword_lookups++, keyword_lookup(word, length))
+#endif
+
+// Extend an identifier over non-ASCII XID_Continue characters and the ASCII
+// identifier bytes between them, starting at the first byte past its ASCII part
+static const char *unicode_identifier_end(const char *p) {
+    uint32_t code_point;
+    int length;
+    while ((unsigned char) *p >= 0x80 && (length = utf8_decode(p, &code_point)) != 0 &&
+           unicode_is_xid_continue(code_point)) {
+        p = scan_identifier(p + length);
+    }
+    return p;
+}
 
-static int current_line = 1;
-static char last_token_type = 'x';
-
-// Keywords table
-static struct {
-    const char *word;
-    TokenType type;
-} keywords[] = {
-    {"if", TOKEN_IF},
-    {"int", TOKEN_INT},
-    {"char", TOKEN_CHAR},
-    {"string", TOKEN_STRING},
-    {"float", TOKEN_FLOAT},
-    {"double", TOKEN_DOUBLE},
-    {"while", TOKEN_WHILE},
-    {"repeat", TOKEN_REPEAT},
-    {"while", TOKEN_UNTIL},
-    {"factorial", TOKEN_FACTORIAL},
-    {"print", TOKEN_PRINT},
-};
-
-static int is_keyword(const char *word) {
-    for (int i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++) {
-        if (strcmp(word, keywords[i].word) == 0) {
-            return keywords[i].type;
-        }
+// Copy the lexeme of a token out of the source buffer, truncating to fit
+const char *token_lexeme(Token token, const char *input, char *buffer, size_t size) {
+    if (token.type == TOKEN_EOF) {
+        snprintf(buffer, size, "EOF");
+        return buffer;
     }
-    return 0;
+    size_t length = (size_t) token.length < size - 1 ? (size_t) token.length : size - 1;
+    memcpy(buffer, input + token.offset, length);
+    buffer[length] = '\0';
+    return buffer;
 }
 
-void print_error(ErrorType error, int line, const char *lexeme) {
-    printf("Lexical Error at line %d: ", line);
+void print_error(ErrorType error, SourceLocation location, const char *lexeme) {
+    printf("Lexical Error at line %d, column %d: ", location.line, location.column);
     switch (error) {
         case ERROR_INVALID_CHAR:
             printf("Invalid character '%s'\n", lexeme);
@@ -53,14 +58,20 @@ void print_error(ErrorType error, int line, const char *lexeme) {
         case ERROR_UNEXPECTED_TOKEN:
             printf("Unexpected token '%s'\n", lexeme);
             break;
+        case ERROR_STRING_TOO_LONG:
+            printf("String literal too long\n");
+            break;
         default:
             printf("Unknown error\n");
     }
 }
 
-void print_token(Token token) {
+void print_token(Token token, const char *input, SourceLocation location) {
+    char lexeme[100];
+    token_lexeme(token, input, lexeme, sizeof(lexeme));
+
     if (token.error != ERROR_NONE) {
-        print_error(token.error, token.line, token.lexeme);
+        print_error(token.error, location, lexeme);
         return;
     }
 
@@ -118,266 +129,184 @@ void print_token(Token token) {
             break;
         default: printf("UNKNOWN");
     }
-    printf(" | Lexeme: '%s' | Line: %d\n", token.lexeme, token.line);
+    printf(" | Lexeme: '%s' | Line: %d\n", lexeme, location.line);
+}
+
+void lexer_init(Lexer *lexer, const char *input) {
+    lexer->source = input;
+    lexer->position = 0;
+    lexer->last_token_type = 'x';
+    lexer->interns = NULL;
 }
 
-Token get_next_token(const char *input, int *pos) {
-    Token token = {TOKEN_ERROR, "", current_line, ERROR_NONE};
-    char c;
+Token get_next_token(Lexer *lexer) {
+    const char *input = lexer->source;
+    Token token = {.type = TOKEN_ERROR, .offset = lexer->position, .error = ERROR_NONE};
+    const char *p = input + lexer->position;
 
-    // Skip whitespace and track line numbers
-    while ((c = input[*pos]) != '\0' && (c == ' ' || c == '\n' || c == '\t')) {
-        if (c == '\n') {
-            current_line++;
+    // Skip whitespace and comments
+    for (;;) {
+        p = scan_whitespace(p);
+
+        if (p[0] == '/' && p[1] == '/') {
+            p = scan_line_end(p);
+        } else if (p[0] == '/' && p[1] == '*') {
+            p = scan_block_comment(p + 2);
+            if (*p != '\0') p += 2;
+        } else {
+            break;
         }
-        (*pos)++;
     }
 
-    if (input[*pos] == '\0') {
+    lexer->position = (int) (p - input);
+    token.offset = lexer->position;
+
+    if (*p == '\0') {
         token.type = TOKEN_EOF;
-        strcpy(token.lexeme, "EOF");
         return token;
     }
 
-    c = input[*pos];
-
-    // Handle comments
-    if (c == '/' && input[*pos + 1] == '/') {
-        while (input[*pos] != '\n' && input[*pos] != '\0') {
-            (*pos)++;
+    // Run the token DFA: one class lookup and one transition per byte
+    const char *start = p;
+    unsigned state = lex_transitions[LEX_START][char_class[(unsigned char) *p++]];
+    while (state < LEX_FIRST_ACCEPT) {
+        // Runs of identifier bytes or digits are skipped in bulk; the next
+        // transition then sees the byte that ends them
+        if (state == LEX_IDENTIFIER) {
+            p = scan_identifier(p);
+        } else if (state == LEX_NUMBER || state == LEX_DECIMAL) {
+            p = scan_digits(p);
         }
-        return get_next_token(input, pos);
+        state = lex_transitions[state][char_class[(unsigned char) *p++]];
     }
-    if (c == '/' && input[*pos + 1] == '*') {
-        (*pos) += 2;
-        while (!(input[*pos] == '*' && input[*pos + 1] == '/') && input[*pos] != '\0') {
-            if (input[*pos] == '\n') current_line++;
-            (*pos)++;
-        }
-        if (input[*pos] != '\0') (*pos) += 2;
-        return get_next_token(input, pos);
-    }
-
-    // Handle numbers
-    if (isdigit(c)) {
-        int i = 0;
-        int dot = 0;
-        do {
-            token.lexeme[i++] = c;
-            (*pos)++;
-            c = input[*pos];
-            if (c == '.') {
-                if (dot) {
-                    token.lexeme[i] = c;
-                    token.error = ERROR_INVALID_NUMBER;
-                }
-                dot = 1;
+    if (!lex_accepts[state - LEX_FIRST_ACCEPT].consume) p--;
+
+    token.type = lex_accepts[state - LEX_FIRST_ACCEPT].type;
+    token.error = lex_accepts[state - LEX_FIRST_ACCEPT].error;
+    token.length = (int) (p - start);
+    lexer->position = (int) (p - input);
+
+    switch (state) {
+        case LEX_ACCEPT_IDENTIFIER: {
+            if ((unsigned char) *p >= 0x80) {
+                p = unicode_identifier_end(p);
+                token.length = (int) (p - start);
+                lexer->position = (int) (p - input);
             }
-        } while ((isdigit(c) || c == '.') && i < sizeof(token.lexeme) - 1);
 
-        if (isalpha(c) || c == '_') {
-            token.error = ERROR_INVALID_IDENTIFIER;
-            while (isalnum(c) && i < sizeof(token.lexeme) - 1) {
-                token.lexeme[i++] = c;
-                (*pos)++;
-                c = input[*pos];
+            // Check for keyword first
+            int keyword = keyword_lookup(start, token.length);
+            if (keyword) {
+                token.type = keyword;
+                break;
             }
-            token.lexeme[i] = '\0';
-            return token;
-        }
 
-        token.lexeme[i] = '\0';
-        token.type = TOKEN_NUMBER;
-        return token;
-    }
-
-    // Handle identifiers and keywords
-    if (isalpha(c) || c == '_') {
-        int i = 0;
-        do {
-            token.lexeme[i++] = c;
-            (*pos)++;
-            c = input[*pos];
-        } while ((isalnum(c) || c == '_') && i < sizeof(token.lexeme) - 1);
-
-        token.lexeme[i] = '\0';
-
-        // Check for keyword first
-        if (is_keyword(token.lexeme)) {
-            token.type = is_keyword(token.lexeme);
-        } else {
-            char temp_lexeme[sizeof(token.lexeme)];
-            strncpy(temp_lexeme, token.lexeme, sizeof(token.lexeme));
-            temp_lexeme[strlen(token.lexeme)] = '\0';
-
-            int is_partial_keyword = 0;
-            for (int j = 1; j < strlen(temp_lexeme); j++) {
-                char temp_substr[sizeof(token.lexeme)];
-                strncpy(temp_substr, temp_lexeme, j);
-                temp_substr[j] = '\0';
-
-                if (is_keyword(temp_substr)) {
-                    is_partial_keyword = 1;
+            // An identifier may not start with a keyword; only prefixes up to the
+            // longest keyword can match, so this check is constant per identifier
+            for (int j = 1; j < token.length && j <= KEYWORD_MAX_LENGTH; j++) {
+                if (keyword_lookup(start, j)) {
+                    token.type = TOKEN_ERROR;
+                    token.error = ERROR_INVALID_IDENTIFIER;
                     break;
                 }
             }
-
-            if (is_partial_keyword) {
-                token.type = TOKEN_ERROR;
-                token.error = ERROR_INVALID_IDENTIFIER;
-            } else {
-                token.type = TOKEN_IDENTIFIER;
+            if (token.type == TOKEN_IDENTIFIER && lexer->interns) {
+                token.symbol = intern(lexer->interns, start, (uint32_t) token.length);
             }
+            break;
         }
-
-        return token;
-    }
-
-    // Handle string literals
-    if (c == '"' || c == '\'') {
-        int i = 0;
-        char quote_type = c;
-
-        (*pos)++;
-        while (input[*pos] != quote_type && input[*pos] != '\0' && i < sizeof(token.lexeme) - 1) {
-            token.lexeme[i++] = input[*pos];
-            (*pos)++;
-        }
-
-        if (input[*pos] == '\0') {
-            token.error = ERROR_UNTERMINATED_STRING;
-            return token;
-        }
-
-        (*pos)++; // Consume closing quote
-
-        if (quote_type == '\'' && i > 1) {
-            // Checking if char length is greater than one
-            token.error = ERROR_CHAR_TOO_LONG;
-            return token;
+        case LEX_ACCEPT_NON_ASCII: {
+            // A character that may start an identifier starts one (keywords are all
+            // ASCII); any other character, or a malformed sequence, is invalid
+            uint32_t code_point;
+            int length = utf8_decode(start, &code_point);
+            if (length != 0 && unicode_is_xid_start(code_point)) {
+                p = unicode_identifier_end(start);
+                token.type = TOKEN_IDENTIFIER;
+                token.error = ERROR_NONE;
+                if (lexer->interns) token.symbol = intern(lexer->interns, start, (uint32_t) (p - start));
+            } else {
+                p = start + (length != 0 ? length : 1);
+            }
+            token.length = (int) (p - start);
+            lexer->position = (int) (p - input);
+            break;
         }
+        case LEX_ACCEPT_QUOTE: {
+            // Handle string literals
+            char quote_type = *start;
 
-        token.lexeme[i] = '\0';
-        token.type = TOKEN_STRING;
-        return token;
-    }
-
-    if (strchr("!=&|", c)) {
-        int len = 1;
-        if (c == '=') {
-            token.type = TOKEN_ASSIGN;
-            token.lexeme[0] = c;
-            token.lexeme[1] = '\0';
-            if (input[*pos + 1] == '=') {
-                token.type = TOKEN_EQ;
-                token.lexeme[1] = input[*pos + 1];
-                token.lexeme[2] = '\0';
-                len = 2;
-            }
-        } else if (c == '!') {
-            token.type = TOKEN_FACTORIAL;
-            token.lexeme[0] = c;
-            token.lexeme[1] = '\0';
-            if (input[*pos + 1] == '=') {
-                token.type = TOKEN_NEQ;
-                token.lexeme[1] = input[*pos + 1];
-                token.lexeme[2] = '\0';
-                len = 2;
+            token.offset = lexer->position;
+            while (input[lexer->position] != quote_type && input[lexer->position] != '\0') {
+                lexer->position++;
             }
-        } else if (c == '&') {
-            token.type = TOKEN_ADDRESS;
-            token.lexeme[0] = c;
-            token.lexeme[1] = '\0';
-            if (input[*pos + 1] == '&') {
-                token.type = TOKEN_AND;
-                token.lexeme[1] = input[*pos + 1];
-                token.lexeme[2] = '\0';
-                len = 2;
+            token.length = lexer->position - token.offset;
+
+            if (input[lexer->position] == '\0') {
+                token.type = TOKEN_ERROR;
+                token.error = ERROR_UNTERMINATED_STRING;
+                break;
             }
-        } else if (c == '|' && input[*pos + 1] == '|') {
-            token.type = TOKEN_OR;
-            token.lexeme[0] = c;
-            token.lexeme[1] = input[*pos + 1];
-            token.lexeme[2] = '\0';
-            len = 2;
-        }
-        (*pos) += len;
-        return token;
-    }
 
-    // Handle operators and delimiters
-    (*pos)++;
-    token.lexeme[0] = c;
-    token.lexeme[1] = '\0';
+            lexer->position++; // Consume closing quote
 
-    switch (c) {
-        case '+':
-            token.type = TOKEN_PLUS;
-            if (last_token_type == 'o') {
-                token.error = ERROR_CONSECUTIVE_OPERATORS;
-                return token;
+            if (quote_type == '\'' && token.length > 1) {
+                // Checking if char length is greater than one
+                token.type = TOKEN_ERROR;
+                token.error = ERROR_CHAR_TOO_LONG;
             }
-            last_token_type = 'o';
             break;
-        case '-':
-            token.type = TOKEN_MINUS;
-            if (last_token_type == 'o') {
+        }
+        case LEX_ACCEPT_OPERATOR:
+            token.type = punctuation_tokens[(unsigned char) *start];
+            if (lexer->last_token_type == 'o') {
                 token.error = ERROR_CONSECUTIVE_OPERATORS;
-                return token;
+                break;
             }
-            last_token_type = 'o';
+            lexer->last_token_type = 'o';
             break;
-        case '*':
-            token.type = TOKEN_STAR;
-            if (last_token_type == 'o') {
-                token.error = ERROR_CONSECUTIVE_OPERATORS;
-                return token;
-            }
-            last_token_type = 'o';
+        case LEX_ACCEPT_PUNCTUATION:
+            token.type = punctuation_tokens[(unsigned char) *start];
             break;
-        case '/':
-            token.type = TOKEN_SLASH;
-            if (last_token_type == 'o') {
-                token.error = ERROR_CONSECUTIVE_OPERATORS;
-                return token;
+        case LEX_ACCEPT_NUMBER:
+        case LEX_ACCEPT_BAD_IDENTIFIER: {
+            // Non-ASCII identifier characters run into a number just like letters do
+            const char *end = unicode_identifier_end(p);
+            if (end != p) {
+                token.type = TOKEN_ERROR;
+                token.error = ERROR_INVALID_IDENTIFIER;
+                token.length = (int) (end - start);
+                lexer->position = (int) (end - input);
+                break;
             }
-            last_token_type = 'o';
-            break;
-        case '!':
-            token.type = TOKEN_FACTORIAL;
-            last_token_type = '!';
-            break;
-        case '<':
-            token.type = TOKEN_LT;
-            break;
-        case '>':
-            token.type = TOKEN_GT;
+            if (state == LEX_ACCEPT_NUMBER) token.number = convert_number(start, token.length);
             break;
-        case ';':
-            token.type = TOKEN_SEMICOLON;
-            break;
-        case '(':
-            token.type = TOKEN_LPAREN;
-            break;
-        case ')':
-            token.type = TOKEN_RPAREN;
-            break;
-        case '{':
-            token.type = TOKEN_LBRACE;
-            break;
-        case '}':
-            token.type = TOKEN_RBRACE;
-            break;
-        case ',':
-            token.type = TOKEN_COMMA;
+        }
         default:
-            token.error = ERROR_INVALID_CHAR;
             break;
     }
 
     return token;
 }
 
+// Tokenize the rest of the lexer's input into tokens, up to and including the
+// EOF token. Returns 0 on success, -1 if the buffer ran out of memory.
+int lex_all(Lexer *lexer, TokenBuffer *tokens) {
+    // Source text averages well under one token per three bytes; sizing for that
+    // up front keeps the arrays from being regrown and copied along the way
+    size_t estimate = strlen(lexer->source + lexer->position) / 3 + 16;
+    if (estimate > UINT32_MAX / 2) estimate = UINT32_MAX / 2;
+    if (token_buffer_reserve(tokens, tokens->count + (uint32_t) estimate) != 0) return -1;
+
+    Token token;
+    do {
+        token = get_next_token(lexer);
+        if (token_buffer_push(tokens, token) != 0) return -1;
+        if (token.type == TOKEN_IDENTIFIER && lexer->interns && token.symbol == 0) return -1;
+    } while (token.type != TOKEN_EOF);
+    return 0;
+}
+
 // int main() {
 //     const char *input = "int x = 123;\n"   // Basic declaration and number
 //                        "test_var = 456;\n"  // Identifier and assignment
@@ -388,12 +317,13 @@ Token get_next_token(const char *input, int *pos) {
 //                        "}";
 //
 //     printf("Analyzing input:\n%s\n\n", input);
-//     int position = 0;
+//     Lexer lexer;
 //     Token token;
 //
+//     lexer_init(&lexer, input);
 //     do {
-//         token = get_next_token(input, &position);
-//         print_token(token);
+//         token = get_next_token(&lexer);
+//         print_token(token, input);
 //     } while (token.type != TOKEN_EOF);
 //
 //     return 0;
@@ -0,0 +1,135 @@
+/* number.c */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/number.h"
+
+// The eight-digit conversion reads the digits as one little-endian word
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define NUMBER_SWAR 1
+#else
+#define NUMBER_SWAR 0
+#endif
+
+// Up to 19 digits always fit in a uint64_t
+#define MAX_EXACT_DIGITS 19
+
+// Significant digits that can decide how a decimal rounds to a double (at most 767
+// do); past these only whether any digit is non-zero matters
+#define MAX_ROUNDING_DIGITS 800
+
+// Every power of ten a double holds exactly
+static const double powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#if NUMBER_SWAR
+
+// Whether all eight bytes of chunk are ASCII digits: each has high nibble 3, and
+// adding 6 does not carry out of the low nibble
+static int eight_digits_valid(uint64_t chunk) {
+    return ((chunk & 0xF0F0F0F0F0F0F0F0u) | ((chunk + 0x0606060606060606u) & 0xF0F0F0F0F0F0F0F0u) >> 4) ==
+           0x3333333333333333u;
+}
+
+// Value of eight ASCII digits, the first one most significant, combining
+// neighbouring digits, then pairs, then quads with one multiply each
+static uint32_t eight_digits(uint64_t chunk) {
+    chunk -= 0x3030303030303030u;
+    chunk = chunk * 10 + (chunk >> 8);
+    chunk = ((chunk & 0x000000FF000000FFu) * 0x000F424000000064u +
+             ((chunk >> 16) & 0x000000FF000000FFu) * 0x0000271000000001u) >> 32;
+    return (uint32_t) chunk;
+}
+
+#endif
+
+// Append the digits from p up to the first non-digit before end to *value, eight
+// at a time while they last. The value wraps past 19 digits; callers check the count.
+static const char *append_digits(const char *p, const char *end, uint64_t *value) {
+    uint64_t v = *value;
+#if NUMBER_SWAR
+    while (end - p >= 8) {
+        uint64_t chunk;
+        memcpy(&chunk, p, sizeof(chunk));
+        if (!eight_digits_valid(chunk)) break;
+        v = v * 100000000u + eight_digits(chunk);
+        p += 8;
+    }
+#endif
+    for (; p < end && (unsigned) (*p - '0') < 10; p++) v = v * 10 + (uint64_t) (*p - '0');
+    *value = v;
+    return p;
+}
+
+NumberValue convert_number(const char *text, int length) {
+    NumberValue number;
+    const char *end = text + length;
+
+    // Leading zeros add nothing
+    const char *p = text;
+    while (p < end && *p == '0') p++;
+    const char *significant = p;
+
+    uint64_t mantissa = 0;
+    p = append_digits(p, end, &mantissa);
+    if (p == end) {
+        number.flags = 0;
+        if (p - significant > MAX_EXACT_DIGITS || mantissa > INT64_MAX) {
+            number.flags = NUMBER_OVERFLOW;
+            mantissa = INT64_MAX;
+        }
+        number.integer = (int64_t) mantissa;
+        return number;
+    }
+
+    // Stopped at the '.': continue with the fraction as part of the same mantissa
+    number.flags = NUMBER_DECIMAL;
+    const char *dot = p++;
+    if (significant == dot) {
+        while (p < end && *p == '0') p++;
+        significant = p;
+    }
+    append_digits(p, end, &mantissa);
+    int digits = (int) (end - significant) - (significant < dot);
+    int scale = (int) (end - dot - 1);
+
+    // Fast path: the digits make an exactly representable mantissa and 10^scale is
+    // exact too, so one IEEE division rounds the quotient correctly
+    if (digits <= MAX_EXACT_DIGITS && mantissa <= (uint64_t) 1 << 53 &&
+        scale < (int) (sizeof(powers_of_ten) / sizeof(powers_of_ten[0]))) {
+        number.decimal = (double) mantissa / powers_of_ten[scale];
+        return number;
+    }
+
+    // Slow path: strtod() on the significant digits with the point turned into an
+    // exponent, "12.5" as "125e-1". strtod() reads the decimal point of the current
+    // LC_NUMERIC locale, so the lexeme itself would convert wrongly where that is ','.
+    char buffer[MAX_ROUNDING_DIGITS + 16];
+    int count = 0;
+    int exponent = -scale;
+    int sticky = 0;
+    for (p = significant; p < end; p++) {
+        if (*p == '.') continue;
+        if (count < MAX_ROUNDING_DIGITS) {
+            buffer[count++] = *p;
+        } else {
+            // Dropped digits scale the kept ones up; a non-zero one becomes a final '1'
+            exponent++;
+            sticky |= *p != '0';
+        }
+    }
+    if (sticky) {
+        buffer[count++] = '1';
+        exponent--;
+    }
+    if (count == 0) buffer[count++] = '0';
+    snprintf(buffer + count, sizeof(buffer) - count, "e%d", exponent);
+
+    number.decimal = strtod(buffer, NULL);
+    if (isinf(number.decimal)) number.flags |= NUMBER_OVERFLOW;
+    return number;
+}
@@ -0,0 +1,298 @@
+/* parallel_lexer.c */
+// Speculative parallel lexing. Every chunk is lexed as if it started at a token
+// boundary outside any comment or string, with no operator seen yet. Stitching
+// then walks the chunks in order with a real lexer: as soon as the real lexer
+// stands at a position where the chunk's lexer also stood after one of its
+// tokens, the rest of the chunk is known to be right up to the consecutive-operator
+// state, which is patched while copying. Where the guess was wrong (a chunk starting inside a
+// block comment or a string), the real lexer re-lexes until the two agree.
+// Identifiers are interned in one ordered pass at the end, so IDs come out in
+// first-occurrence order just as with sequential lexing.
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/parallel_lexer.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PARALLEL_THREADS 1
+#include <pthread.h>
+#include <unistd.h>
+#else
+#define PARALLEL_THREADS 0
+#endif
+
+#define MAX_CHUNKS 256
+
+typedef struct {
+    const char *source;
+    uint32_t start; // First byte of the chunk
+    uint32_t end; // First byte of the next chunk
+    int last; // The final chunk, lexed through to EOF
+
+    // Speculative lexing results
+    TokenBuffer tokens;
+    uint32_t *end_position; // Lexer position after each token
+    int64_t last_operator; // Index of the last + - * / token, -1 if none
+    int failed; // Ran out of memory
+
+    // Stitching results
+    TokenBuffer bridge; // Tokens the real lexer produced before it caught up with the chunk
+    uint32_t first_valid; // Speculative tokens [first_valid, valid_end) are kept
+    uint32_t valid_end;
+    char last_token_type; // Real last_token_type before tokens[first_valid]
+    uint32_t output; // Index of the chunk's first token in the output buffer
+} Chunk;
+
+static int is_operator(uint8_t type) {
+    return type == TOKEN_PLUS || type == TOKEN_MINUS || type == TOKEN_STAR || type == TOKEN_SLASH;
+}
+
+static int reserve_chunk(Chunk *chunk, uint32_t capacity) {
+    if (token_buffer_reserve(&chunk->tokens, capacity) != 0) return -1;
+
+    uint32_t *position = realloc(chunk->end_position, sizeof(*position) * capacity);
+    if (!position) return -1;
+    chunk->end_position = position;
+    return 0;
+}
+
+// Lex one chunk speculatively, stopping once the lexer has left it
+static void lex_chunk(Chunk *chunk, TokenBuffer *out) {
+    (void) out;
+    Lexer lexer;
+    lexer_init(&lexer, chunk->source);
+    lexer.position = (int) chunk->start;
+    chunk->last_operator = -1;
+
+    if (reserve_chunk(chunk, (chunk->end - chunk->start) / 3 + 16) != 0) {
+        chunk->failed = 1;
+        return;
+    }
+
+    while ((uint32_t) lexer.position < chunk->end || chunk->last) {
+        Token token = get_next_token(&lexer);
+        uint32_t i = chunk->tokens.count;
+        if (i == chunk->tokens.capacity &&
+            (i > UINT32_MAX / 2 || reserve_chunk(chunk, i * 2) != 0)) {
+            chunk->failed = 1;
+            return;
+        }
+        token_buffer_push(&chunk->tokens, token);
+        chunk->end_position[i] = (uint32_t) lexer.position;
+        if (is_operator((uint8_t) token.type)) chunk->last_operator = i;
+
+        if (token.type == TOKEN_EOF) break;
+    }
+}
+
+// Copy a stitched chunk into its slot of the output buffer
+static void emit_chunk(Chunk *chunk, TokenBuffer *out) {
+    const TokenBuffer *bridge = &chunk->bridge;
+    uint32_t o = chunk->output;
+
+    if (bridge->count > 0) {
+        memcpy(out->type + o, bridge->type, bridge->count * sizeof(*out->type));
+        memcpy(out->error + o, bridge->error, bridge->count * sizeof(*out->error));
+        memcpy(out->offset + o, bridge->offset, bridge->count * sizeof(*out->offset));
+        memcpy(out->length + o, bridge->length, bridge->count * sizeof(*out->length));
+        memcpy(out->symbol + o, bridge->symbol, bridge->count * sizeof(*out->symbol));
+        memcpy(out->number + o, bridge->number, bridge->count * sizeof(*out->number));
+        memcpy(out->number_flags + o, bridge->number_flags, bridge->count * sizeof(*out->number_flags));
+        o += bridge->count;
+    }
+
+    const TokenBuffer *tokens = &chunk->tokens;
+    uint32_t first = chunk->first_valid;
+    uint32_t count = chunk->valid_end - first;
+    memcpy(out->type + o, tokens->type + first, count * sizeof(*out->type));
+    memcpy(out->offset + o, tokens->offset + first, count * sizeof(*out->offset));
+    memcpy(out->length + o, tokens->length + first, count * sizeof(*out->length));
+    memcpy(out->symbol + o, tokens->symbol + first, count * sizeof(*out->symbol));
+    memcpy(out->number + o, tokens->number + first, count * sizeof(*out->number));
+    memcpy(out->number_flags + o, tokens->number_flags + first, count * sizeof(*out->number_flags));
+
+    // The speculation started with no operator seen, so redo the consecutive
+    // operator check from the real state
+    char last_token_type = chunk->last_token_type;
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t error = tokens->error[first + i];
+        if (is_operator(tokens->type[first + i])) {
+            error = last_token_type == 'o' ? ERROR_CONSECUTIVE_OPERATORS : ERROR_NONE;
+            last_token_type = 'o';
+        }
+        out->error[o + i] = error;
+    }
+}
+
+#if PARALLEL_THREADS
+
+typedef struct {
+    void (*run)(Chunk *chunk, TokenBuffer *out);
+    Chunk *chunk;
+    TokenBuffer *out;
+} Task;
+
+static void *run_task(void *arg) {
+    Task *task = arg;
+    task->run(task->chunk, task->out);
+    return NULL;
+}
+
+#endif
+
+// Run `run` on every chunk, one thread per chunk with the first on the calling thread
+static void run_chunks(void (*run)(Chunk *, TokenBuffer *), Chunk *chunks, int count, TokenBuffer *out) {
+#if PARALLEL_THREADS
+    Task tasks[MAX_CHUNKS];
+    pthread_t threads[MAX_CHUNKS];
+    int started[MAX_CHUNKS] = {0};
+
+    for (int k = 1; k < count; k++) {
+        tasks[k] = (Task){run, &chunks[k], out};
+        started[k] = pthread_create(&threads[k], NULL, run_task, &tasks[k]) == 0;
+    }
+    run(&chunks[0], out);
+    for (int k = 1; k < count; k++) {
+        // A thread that could not be started runs its chunk here instead
+        if (started[k]) {
+            pthread_join(threads[k], NULL);
+        } else {
+            run(&chunks[k], out);
+        }
+    }
+#else
+    for (int k = 0; k < count; k++) run(&chunks[k], out);
+#endif
+}
+
+// Walk the chunks in order with the real lexer and decide which speculative
+// tokens to keep. Returns 0 on success, -1 if out of memory.
+static int stitch(Chunk *chunks, int count, Lexer *lexer) {
+    Lexer real = *lexer;
+    real.interns = NULL;
+    int done = 0;
+
+    for (int k = 0; k < count && !done; k++) {
+        Chunk *chunk = &chunks[k];
+
+        // Advance whichever of the two is behind until they stand at the same position
+        int64_t j = -1; // Speculative tokens up to j are discarded
+        int matched = 0;
+        for (;;) {
+            // EOF leaves the position unchanged, so standing where the chunk's lexer
+            // stood after its EOF token does not mean the EOF was already produced
+            uint32_t position = j < 0 ? chunk->start : chunk->end_position[j];
+            int after_eof = j >= 0 && chunk->tokens.type[j] == TOKEN_EOF;
+            if ((uint32_t) real.position == position && !after_eof) {
+                matched = 1;
+                break;
+            }
+            if ((uint32_t) real.position <= position) {
+                Token token = get_next_token(&real);
+                if (token_buffer_push(&chunk->bridge, token) != 0) return -1;
+                if (token.type == TOKEN_EOF) {
+                    done = 1;
+                    break;
+                }
+            } else if (++j >= chunk->tokens.count) {
+                break; // The real lexer passed the whole chunk
+            }
+        }
+        if (!matched) continue;
+
+        chunk->first_valid = (uint32_t) (j + 1);
+        chunk->valid_end = chunk->tokens.count;
+        chunk->last_token_type = real.last_token_type;
+
+        if (chunk->valid_end > chunk->first_valid) {
+            uint32_t last = chunk->valid_end - 1;
+            real.position = (int) chunk->end_position[last];
+            if (chunk->last_operator >= (int64_t) chunk->first_valid) real.last_token_type = 'o';
+            if (chunk->tokens.type[last] == TOKEN_EOF) done = 1;
+        }
+    }
+
+    real.interns = lexer->interns;
+    *lexer = real;
+    return 0;
+}
+
+// Intern the identifiers among tokens [first, count) in order
+static int intern_identifiers(TokenBuffer *tokens, uint32_t first, Lexer *lexer) {
+    for (uint32_t i = first; i < tokens->count; i++) {
+        if (tokens->type[i] != TOKEN_IDENTIFIER) continue;
+        tokens->symbol[i] = intern(lexer->interns, lexer->source + tokens->offset[i], tokens->length[i]);
+        if (tokens->symbol[i] == 0) return -1;
+    }
+    return 0;
+}
+
+static int online_cpus(void) {
+#if PARALLEL_THREADS && defined(_SC_NPROCESSORS_ONLN)
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int) cpus : 1;
+#else
+    return 1;
+#endif
+}
+
+int lex_all_parallel(Lexer *lexer, TokenBuffer *tokens, int threads) {
+    const char *source = lexer->source;
+    uint32_t start = (uint32_t) lexer->position;
+    uint32_t length = (uint32_t) strlen(source + start);
+
+    if (threads <= 0) threads = online_cpus();
+    int count = threads < MAX_CHUNKS ? threads : MAX_CHUNKS;
+    if (length / PARALLEL_LEX_MIN_CHUNK < (uint32_t) count) count = (int) (length / PARALLEL_LEX_MIN_CHUNK);
+    if (count <= 1) return lex_all(lexer, tokens);
+
+    Chunk *chunks = calloc((size_t) count, sizeof(Chunk));
+    if (!chunks) return -1;
+
+    // Split at the first newline after each even share of the input
+    uint32_t end = start + length;
+    for (int k = 0; k < count; k++) {
+        chunks[k].source = source;
+        chunks[k].start = k == 0 ? start : chunks[k - 1].end;
+        if (k == count - 1) {
+            chunks[k].end = end;
+            chunks[k].last = 1;
+        } else {
+            uint32_t target = start + (uint32_t) ((uint64_t) length * (k + 1) / count);
+            if (target < chunks[k].start) target = chunks[k].start;
+            const char *newline = memchr(source + target, '\n', end - target);
+            chunks[k].end = newline ? (uint32_t) (newline - source) + 1 : end;
+        }
+    }
+
+    int status = 0;
+    run_chunks(lex_chunk, chunks, count, tokens);
+    for (int k = 0; k < count; k++) {
+        if (chunks[k].failed) status = -1;
+    }
+
+    if (status == 0) status = stitch(chunks, count, lexer);
+
+    if (status == 0) {
+        uint32_t total = tokens->count;
+        for (int k = 0; k < count; k++) {
+            chunks[k].output = total;
+            total += chunks[k].bridge.count + chunks[k].valid_end - chunks[k].first_valid;
+        }
+        status = token_buffer_reserve(tokens, total);
+        if (status == 0) {
+            uint32_t first = tokens->count;
+            run_chunks(emit_chunk, chunks, count, tokens);
+            tokens->count = total;
+            if (lexer->interns) status = intern_identifiers(tokens, first, lexer);
+        }
+    }
+
+    for (int k = 0; k < count; k++) {
+        token_buffer_free(&chunks[k].tokens);
+        token_buffer_free(&chunks[k].bridge);
+        free(chunks[k].end_position);
+    }
+    free(chunks);
+    return status;
+}
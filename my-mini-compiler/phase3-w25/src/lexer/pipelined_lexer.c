@@ -0,0 +1,190 @@
+/* pipelined_lexer.c */
+// The ring has one writer and one reader. The lexer thread owns `head`, the parser
+// owns `tail`; each publishes its index with a release store and reads the other's
+// with an acquire load, so a slot is never read before it is written or written
+// before it is read. Each side keeps a private copy of the other's index and only
+// reloads it when the ring looks full (or empty), and the lexer thread publishes
+// tokens in batches, so the two cache lines change hands rarely.
+#include <stdlib.h>
+
+#include "../../include/pipelined_lexer.h"
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__STDC_NO_ATOMICS__)
+#define PIPELINE_THREADS 1
+#include <pthread.h>
+#include <sched.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#else
+#define PIPELINE_THREADS 0
+#endif
+
+#if PIPELINE_THREADS
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#include <immintrin.h>
+#define cpu_relax() _mm_pause()
+#else
+#define cpu_relax() ((void) 0)
+#endif
+
+#define MASK (LEX_PIPELINE_CAPACITY - 1)
+
+// Tokens the lexer thread writes before it publishes them
+#define PUBLISH_BATCH 64
+
+// Spins before a waiting side yields its CPU, which it must when both threads share one
+#define SPINS 64
+
+enum {
+    PIPELINE_RUNNING,
+    PIPELINE_DONE, // The lexer thread reached EOF or was stopped
+    PIPELINE_FAILED // The lexer thread ran out of memory interning
+};
+
+struct LexPipeline {
+    Token slots[LEX_PIPELINE_CAPACITY];
+    Lexer *lexer;
+    pthread_t thread;
+
+    // Written by the lexer thread
+    alignas(64) atomic_uint head; // Tokens published so far
+    atomic_int state;
+    uint32_t cached_tail; // Last tail the lexer thread saw
+
+    // Written by the parser
+    alignas(64) atomic_uint tail; // Tokens consumed so far
+    atomic_int stop; // The parser gave up on the rest of the stream
+    uint32_t cached_head; // Last head the parser saw
+};
+
+static void wait_a_little(unsigned *spins) {
+    if (++*spins < SPINS) {
+        cpu_relax();
+    } else {
+        sched_yield();
+    }
+}
+
+static void *run_lexer(void *argument) {
+    LexPipeline *pipeline = argument;
+    Lexer *lexer = pipeline->lexer;
+    uint32_t head = 0;
+    uint32_t published = 0;
+    int state = PIPELINE_DONE;
+
+    for (;;) {
+        if (head - pipeline->cached_tail == LEX_PIPELINE_CAPACITY) {
+            // Full: hand over what is written, then wait for the parser to make room
+            atomic_store_explicit(&pipeline->head, head, memory_order_release);
+            published = head;
+            unsigned spins = 0;
+            for (;;) {
+                pipeline->cached_tail = atomic_load_explicit(&pipeline->tail, memory_order_acquire);
+                if (head - pipeline->cached_tail < LEX_PIPELINE_CAPACITY) break;
+                if (atomic_load_explicit(&pipeline->stop, memory_order_relaxed)) goto out;
+                wait_a_little(&spins);
+            }
+        }
+
+        Token token = get_next_token(lexer);
+        pipeline->slots[head & MASK] = token;
+        head++;
+        if (token.type == TOKEN_EOF) break;
+        if (token.type == TOKEN_IDENTIFIER && lexer->interns && token.symbol == 0) {
+            state = PIPELINE_FAILED;
+            break;
+        }
+
+        if (head - published >= PUBLISH_BATCH) {
+            atomic_store_explicit(&pipeline->head, head, memory_order_release);
+            published = head;
+            if (atomic_load_explicit(&pipeline->stop, memory_order_relaxed)) break;
+        }
+    }
+
+out:
+    // The final head goes out before the state, so a reader that sees the state
+    // change also sees every token
+    atomic_store_explicit(&pipeline->head, head, memory_order_release);
+    atomic_store_explicit(&pipeline->state, state, memory_order_release);
+    return NULL;
+}
+
+LexPipeline *lex_pipeline_start(Lexer *lexer) {
+#ifdef _SC_NPROCESSORS_ONLN
+    // On one CPU the two threads only take turns, and each turn costs a context switch
+    if (sysconf(_SC_NPROCESSORS_ONLN) < 2) return NULL;
+#endif
+    LexPipeline *pipeline = aligned_alloc(alignof(LexPipeline), sizeof(LexPipeline));
+    if (!pipeline) return NULL;
+
+    pipeline->lexer = lexer;
+    atomic_init(&pipeline->head, 0);
+    atomic_init(&pipeline->state, PIPELINE_RUNNING);
+    pipeline->cached_tail = 0;
+    atomic_init(&pipeline->tail, 0);
+    atomic_init(&pipeline->stop, 0);
+    pipeline->cached_head = 0;
+
+    if (pthread_create(&pipeline->thread, NULL, run_lexer, pipeline) != 0) {
+        free(pipeline);
+        return NULL;
+    }
+    return pipeline;
+}
+
+int lex_pipeline_read(LexPipeline *pipeline, TokenBuffer *tokens) {
+    uint32_t tail = atomic_load_explicit(&pipeline->tail, memory_order_relaxed);
+    unsigned spins = 0;
+    while (pipeline->cached_head == tail) {
+        pipeline->cached_head = atomic_load_explicit(&pipeline->head, memory_order_acquire);
+        if (pipeline->cached_head != tail) break;
+
+        if (atomic_load_explicit(&pipeline->state, memory_order_acquire) != PIPELINE_RUNNING) {
+            pipeline->cached_head = atomic_load_explicit(&pipeline->head, memory_order_acquire);
+            if (pipeline->cached_head == tail) return 0;
+            break;
+        }
+        wait_a_little(&spins);
+    }
+
+    for (uint32_t i = tail; i != pipeline->cached_head; i++) {
+        if (token_buffer_push(tokens, pipeline->slots[i & MASK]) != 0) {
+            atomic_store_explicit(&pipeline->tail, i, memory_order_release);
+            return -1;
+        }
+    }
+    atomic_store_explicit(&pipeline->tail, pipeline->cached_head, memory_order_release);
+    return 1;
+}
+
+int lex_pipeline_finish(LexPipeline *pipeline) {
+    atomic_store_explicit(&pipeline->stop, 1, memory_order_relaxed);
+    pthread_join(pipeline->thread, NULL);
+
+    int failed = atomic_load_explicit(&pipeline->state, memory_order_relaxed) == PIPELINE_FAILED;
+    free(pipeline);
+    return failed ? -1 : 0;
+}
+
+#else
+
+LexPipeline *lex_pipeline_start(Lexer *lexer) {
+    (void) lexer;
+    return NULL;
+}
+
+int lex_pipeline_read(LexPipeline *pipeline, TokenBuffer *tokens) {
+    (void) pipeline;
+    (void) tokens;
+    return 0;
+}
+
+int lex_pipeline_finish(LexPipeline *pipeline) {
+    (void) pipeline;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,452 @@
+/* scan.c */
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/scan.h"
+
+// The vector paths only ever issue aligned loads, so a load never crosses a
+// page boundary and reading the rest of the block past the NUL terminator is safe.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define SCAN_X86 1
+#include <immintrin.h>
+#else
+#define SCAN_X86 0
+#endif
+
+static inline int is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n';
+}
+
+static inline int is_digit(char c) {
+    return (unsigned char) (c - '0') < 10;
+}
+
+static inline int is_identifier_byte(char c) {
+    return (unsigned char) ((c | 0x20) - 'a') < 26 || is_digit(c) || c == '_';
+}
+
+// =============== Scalar, one byte per step ===============
+
+static const char *whitespace_scalar(const char *p) {
+    while (is_space(*p)) p++;
+    return p;
+}
+
+static const char *line_end_scalar(const char *p) {
+    while (*p != '\n' && *p != '\0') p++;
+    return p;
+}
+
+static const char *block_comment_scalar(const char *p) {
+    while (!(p[0] == '*' && p[1] == '/') && *p != '\0') p++;
+    return p;
+}
+
+static const char *identifier_scalar(const char *p) {
+    while (is_identifier_byte(*p)) p++;
+    return p;
+}
+
+static const char *digits_scalar(const char *p) {
+    while (is_digit(*p)) p++;
+    return p;
+}
+
+static size_t newlines_scalar(const char *p, size_t length, uint32_t *offsets) {
+    size_t count = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (p[i] != '\n') continue;
+        if (offsets) offsets[count] = (uint32_t) i;
+        count++;
+    }
+    return count;
+}
+
+#if SCAN_X86
+
+// =============== SSE2, 16 bytes per step ===============
+
+static const char *whitespace_sse2(const char *p) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i newline = _mm_set1_epi8('\n');
+
+    unsigned misalign = (uintptr_t) p & 15;
+    const char *block = p - misalign;
+    unsigned live = 0xFFFFu << misalign & 0xFFFFu; // Bytes at or after p
+
+    for (;;) {
+        __m128i bytes = _mm_load_si128((const __m128i *) block);
+        __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, space), _mm_cmpeq_epi8(bytes, tab)),
+                                  _mm_cmpeq_epi8(bytes, newline));
+        unsigned other = ~_mm_movemask_epi8(ws) & live;
+        if (other) return block + __builtin_ctz(other);
+        block += 16;
+        live = 0xFFFFu;
+    }
+}
+
+static const char *line_end_sse2(const char *p) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i zero = _mm_setzero_si128();
+
+    unsigned misalign = (uintptr_t) p & 15;
+    const char *block = p - misalign;
+    unsigned live = 0xFFFFu << misalign & 0xFFFFu;
+
+    for (;;) {
+        __m128i bytes = _mm_load_si128((const __m128i *) block);
+        unsigned hit = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(bytes, newline), _mm_cmpeq_epi8(bytes, zero)));
+        hit &= live;
+        if (hit) return block + __builtin_ctz(hit);
+        block += 16;
+        live = 0xFFFFu;
+    }
+}
+
+static const char *block_comment_sse2(const char *p) {
+    const __m128i star = _mm_set1_epi8('*');
+    const __m128i zero = _mm_setzero_si128();
+
+    unsigned misalign = (uintptr_t) p & 15;
+    const char *block = p - misalign;
+    unsigned live = 0xFFFFu << misalign & 0xFFFFu;
+
+    for (;;) {
+        __m128i bytes = _mm_load_si128((const __m128i *) block);
+        unsigned hit = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(bytes, star), _mm_cmpeq_epi8(bytes, zero)));
+        hit &= live;
+
+        if (hit) {
+            unsigned first = __builtin_ctz(hit);
+            const char *found = block + first;
+            if (*found == '\0' || found[1] == '/') return found;
+
+            // A lone '*': keep scanning right after it
+            if (first == 15) {
+                block += 16;
+                live = 0xFFFFu;
+            } else {
+                live = 0xFFFFu << (first + 1) & 0xFFFFu;
+            }
+            continue;
+        }
+        block += 16;
+        live = 0xFFFFu;
+    }
+}
+
+// 0xFF for each byte in [low, high]. Compares are signed, so bytes >= 0x80 never match.
+static inline __m128i in_range_sse2(__m128i bytes, char low, char high) {
+    return _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8((char) (low - 1))),
+                         _mm_cmplt_epi8(bytes, _mm_set1_epi8((char) (high + 1))));
+}
+
+static const char *identifier_sse2(const char *p) {
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    const __m128i underscore = _mm_set1_epi8('_');
+
+    unsigned misalign = (uintptr_t) p & 15;
+    const char *block = p - misalign;
+    unsigned live = 0xFFFFu << misalign & 0xFFFFu;
+
+    for (;;) {
+        __m128i bytes = _mm_load_si128((const __m128i *) block);
+        __m128i word = _mm_or_si128(in_range_sse2(_mm_or_si128(bytes, case_bit), 'a', 'z'),
+                                    _mm_or_si128(in_range_sse2(bytes, '0', '9'), _mm_cmpeq_epi8(bytes, underscore)));
+        unsigned other = ~_mm_movemask_epi8(word) & live;
+        if (other) return block + __builtin_ctz(other);
+        block += 16;
+        live = 0xFFFFu;
+    }
+}
+
+static const char *digits_sse2(const char *p) {
+    unsigned misalign = (uintptr_t) p & 15;
+    const char *block = p - misalign;
+    unsigned live = 0xFFFFu << misalign & 0xFFFFu;
+
+    for (;;) {
+        __m128i bytes = _mm_load_si128((const __m128i *) block);
+        unsigned other = ~_mm_movemask_epi8(in_range_sse2(bytes, '0', '9')) & live;
+        if (other) return block + __builtin_ctz(other);
+        block += 16;
+        live = 0xFFFFu;
+    }
+}
+
+static size_t newlines_sse2(const char *p, size_t length, uint32_t *offsets) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    const char *end = p + length;
+
+    unsigned misalign = (uintptr_t) p & 15;
+    const char *block = p - misalign;
+    unsigned live = 0xFFFFu << misalign & 0xFFFFu;
+    size_t count = 0;
+
+    for (; block < end; block += 16, live = 0xFFFFu) {
+        if (end - block < 16) live &= (1u << (end - block)) - 1; // Bytes before end
+        __m128i bytes = _mm_load_si128((const __m128i *) block);
+        unsigned nl = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)) & live;
+
+        if (!offsets) {
+            count += __builtin_popcount(nl);
+            continue;
+        }
+        for (; nl; nl &= nl - 1) offsets[count++] = (uint32_t) (block + __builtin_ctz(nl) - p);
+    }
+    return count;
+}
+
+// =============== AVX2, 32 bytes per step ===============
+
+__attribute__((target("avx2")))
+static const char *whitespace_avx2(const char *p) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i newline = _mm256_set1_epi8('\n');
+
+    unsigned misalign = (uintptr_t) p & 31;
+    const char *block = p - misalign;
+    unsigned live = ~0u << misalign;
+
+    for (;;) {
+        __m256i bytes = _mm256_load_si256((const __m256i *) block);
+        __m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, space), _mm256_cmpeq_epi8(bytes, tab)),
+                                     _mm256_cmpeq_epi8(bytes, newline));
+        unsigned other = ~(unsigned) _mm256_movemask_epi8(ws) & live;
+        if (other) return block + __builtin_ctz(other);
+        block += 32;
+        live = ~0u;
+    }
+}
+
+__attribute__((target("avx2")))
+static const char *line_end_avx2(const char *p) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i zero = _mm256_setzero_si256();
+
+    unsigned misalign = (uintptr_t) p & 31;
+    const char *block = p - misalign;
+    unsigned live = ~0u << misalign;
+
+    for (;;) {
+        __m256i bytes = _mm256_load_si256((const __m256i *) block);
+        unsigned hit = (unsigned) _mm256_movemask_epi8(
+                           _mm256_or_si256(_mm256_cmpeq_epi8(bytes, newline), _mm256_cmpeq_epi8(bytes, zero)));
+        hit &= live;
+        if (hit) return block + __builtin_ctz(hit);
+        block += 32;
+        live = ~0u;
+    }
+}
+
+__attribute__((target("avx2")))
+static const char *block_comment_avx2(const char *p) {
+    const __m256i star = _mm256_set1_epi8('*');
+    const __m256i zero = _mm256_setzero_si256();
+
+    unsigned misalign = (uintptr_t) p & 31;
+    const char *block = p - misalign;
+    unsigned live = ~0u << misalign;
+
+    for (;;) {
+        __m256i bytes = _mm256_load_si256((const __m256i *) block);
+        unsigned hit = (unsigned) _mm256_movemask_epi8(
+                           _mm256_or_si256(_mm256_cmpeq_epi8(bytes, star), _mm256_cmpeq_epi8(bytes, zero)));
+        hit &= live;
+
+        if (hit) {
+            unsigned first = __builtin_ctz(hit);
+            const char *found = block + first;
+            if (*found == '\0' || found[1] == '/') return found;
+
+            // A lone '*': keep scanning right after it
+            if (first == 31) {
+                block += 32;
+                live = ~0u;
+            } else {
+                live = ~0u << (first + 1);
+            }
+            continue;
+        }
+        block += 32;
+        live = ~0u;
+    }
+}
+
+__attribute__((target("avx2")))
+static inline __m256i in_range_avx2(__m256i bytes, char low, char high) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(bytes, _mm256_set1_epi8((char) (low - 1))),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8((char) (high + 1)), bytes));
+}
+
+__attribute__((target("avx2")))
+static const char *identifier_avx2(const char *p) {
+    const __m256i case_bit = _mm256_set1_epi8(0x20);
+    const __m256i underscore = _mm256_set1_epi8('_');
+
+    unsigned misalign = (uintptr_t) p & 31;
+    const char *block = p - misalign;
+    unsigned live = ~0u << misalign;
+
+    for (;;) {
+        __m256i bytes = _mm256_load_si256((const __m256i *) block);
+        __m256i word = _mm256_or_si256(in_range_avx2(_mm256_or_si256(bytes, case_bit), 'a', 'z'),
+                                       _mm256_or_si256(in_range_avx2(bytes, '0', '9'),
+                                                       _mm256_cmpeq_epi8(bytes, underscore)));
+        unsigned other = ~(unsigned) _mm256_movemask_epi8(word) & live;
+        if (other) return block + __builtin_ctz(other);
+        block += 32;
+        live = ~0u;
+    }
+}
+
+__attribute__((target("avx2")))
+static const char *digits_avx2(const char *p) {
+    unsigned misalign = (uintptr_t) p & 31;
+    const char *block = p - misalign;
+    unsigned live = ~0u << misalign;
+
+    for (;;) {
+        __m256i bytes = _mm256_load_si256((const __m256i *) block);
+        unsigned other = ~(unsigned) _mm256_movemask_epi8(in_range_avx2(bytes, '0', '9')) & live;
+        if (other) return block + __builtin_ctz(other);
+        block += 32;
+        live = ~0u;
+    }
+}
+
+__attribute__((target("avx2,popcnt")))
+static size_t newlines_avx2(const char *p, size_t length, uint32_t *offsets) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const char *end = p + length;
+
+    unsigned misalign = (uintptr_t) p & 31;
+    const char *block = p - misalign;
+    unsigned live = ~0u << misalign;
+    size_t count = 0;
+
+    for (; block < end; block += 32, live = ~0u) {
+        if (end - block < 32) live &= (1u << (end - block)) - 1; // Bytes before end
+        __m256i bytes = _mm256_load_si256((const __m256i *) block);
+        unsigned nl = (unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, newline)) & live;
+
+        if (!offsets) {
+            count += __builtin_popcount(nl);
+            continue;
+        }
+        for (; nl; nl &= nl - 1) offsets[count++] = (uint32_t) (block + __builtin_ctz(nl) - p);
+    }
+    return count;
+}
+
+#endif /* SCAN_X86 */
+
+// =============== Runtime dispatch ===============
+
+ScanLevel scan_best_level(void) {
+#if SCAN_X86
+    if (__builtin_cpu_supports("avx2")) return SCAN_LEVEL_AVX2;
+    return SCAN_LEVEL_SSE2;
+#else
+    return SCAN_LEVEL_SCALAR;
+#endif
+}
+
+static atomic_int selected_level = -1; // ScanLevel, -1 until the first scan
+
+static inline ScanLevel current_level(void) {
+    int level = atomic_load_explicit(&selected_level, memory_order_relaxed);
+    if (level >= 0) return (ScanLevel) level;
+
+    // Every thread that gets here picks the same level, so racing is harmless
+    level = scan_best_level();
+    const char *forced = getenv("MINI_COMPILER_SCAN");
+    if (forced) {
+        int wanted = strcmp(forced, "scalar") == 0 ? SCAN_LEVEL_SCALAR
+                     : strcmp(forced, "sse2") == 0 ? SCAN_LEVEL_SSE2
+                                                    : SCAN_LEVEL_AVX2;
+        if (wanted < level) level = wanted;
+    }
+    atomic_store_explicit(&selected_level, level, memory_order_relaxed);
+    return (ScanLevel) level;
+}
+
+ScanLevel scan_level(void) {
+    return current_level();
+}
+
+ScanLevel scan_set_level(ScanLevel level) {
+    ScanLevel best = scan_best_level();
+    if (level > best) level = best;
+    atomic_store_explicit(&selected_level, (int) level, memory_order_relaxed);
+    return level;
+}
+
+const char *scan_whitespace(const char *p) {
+    // Most gaps between tokens are a byte or two; only go wide for longer runs
+    for (int i = 0; i < 2; i++, p++) {
+        if (!is_space(*p)) return p;
+    }
+    switch (current_level()) {
+#if SCAN_X86
+        case SCAN_LEVEL_AVX2: return whitespace_avx2(p);
+        case SCAN_LEVEL_SSE2: return whitespace_sse2(p);
+#endif
+        default: return whitespace_scalar(p);
+    }
+}
+
+const char *scan_line_end(const char *p) {
+    switch (current_level()) {
+#if SCAN_X86
+        case SCAN_LEVEL_AVX2: return line_end_avx2(p);
+        case SCAN_LEVEL_SSE2: return line_end_sse2(p);
+#endif
+        default: return line_end_scalar(p);
+    }
+}
+
+const char *scan_block_comment(const char *p) {
+    switch (current_level()) {
+#if SCAN_X86
+        case SCAN_LEVEL_AVX2: return block_comment_avx2(p);
+        case SCAN_LEVEL_SSE2: return block_comment_sse2(p);
+#endif
+        default: return block_comment_scalar(p);
+    }
+}
+
+const char *scan_identifier(const char *p) {
+    switch (current_level()) {
+#if SCAN_X86
+        case SCAN_LEVEL_AVX2: return identifier_avx2(p);
+        case SCAN_LEVEL_SSE2: return identifier_sse2(p);
+#endif
+        default: return identifier_scalar(p);
+    }
+}
+
+const char *scan_digits(const char *p) {
+    switch (current_level()) {
+#if SCAN_X86
+        case SCAN_LEVEL_AVX2: return digits_avx2(p);
+        case SCAN_LEVEL_SSE2: return digits_sse2(p);
+#endif
+        default: return digits_scalar(p);
+    }
+}
+
+size_t scan_newlines(const char *p, size_t length, uint32_t *offsets) {
+    switch (current_level()) {
+#if SCAN_X86
+        case SCAN_LEVEL_AVX2: return newlines_avx2(p, length, offsets);
+        case SCAN_LEVEL_SSE2: return newlines_sse2(p, length, offsets);
+#endif
+        default: return newlines_scalar(p, length, offsets);
+    }
+}
@@ -0,0 +1,187 @@
+/* stream_lexer.c */
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/stream_lexer.h"
+#include "../../include/scan.h"
+
+// The scanners load whole aligned 32-byte blocks, so the window is allocated
+// aligned and rounded up to keep the block holding the terminator in bounds
+#define WINDOW_ALIGN 32
+
+// Allocate a window of capacity bytes plus the terminator
+static char *allocate_window(size_t capacity) {
+    size_t size = (capacity + 1 + WINDOW_ALIGN - 1) / WINDOW_ALIGN * WINDOW_ALIGN;
+    return aligned_alloc(WINDOW_ALIGN, size);
+}
+
+int stream_lexer_init(StreamLexer *lexer, FILE *input, size_t capacity) {
+    memset(lexer, 0, sizeof(*lexer));
+    if (capacity < STREAM_MIN_CAPACITY) capacity = STREAM_MIN_CAPACITY;
+
+    lexer->buffer = allocate_window(capacity);
+    if (!lexer->buffer) return -1;
+
+    lexer->input = input;
+    lexer->capacity = capacity;
+    lexer->buffer[0] = '\0';
+    lexer->line = 1;
+    lexer->line_start = 0;
+    lexer_init(&lexer->core, lexer->buffer);
+    return 0;
+}
+
+void stream_lexer_free(StreamLexer *lexer) {
+    free(lexer->buffer);
+    lexer->buffer = NULL;
+}
+
+// Count the newlines before window index end
+static void count_lines(StreamLexer *lexer, size_t end) {
+    size_t newlines = scan_newlines(lexer->buffer + lexer->counted, end - lexer->counted, NULL);
+    if (newlines > 0) {
+        size_t last = end;
+        while (lexer->buffer[last - 1] != '\n') last--;
+        lexer->line += (int64_t) newlines;
+        lexer->line_start = lexer->base + (int64_t) last;
+    }
+    lexer->counted = end;
+}
+
+// Drop everything before lexer->start, slide the rest to the front of the window
+// and top it up from the input. Afterwards the next unread byte is buffer[0].
+static void refill(StreamLexer *lexer) {
+    count_lines(lexer, lexer->start);
+    lexer->counted = 0;
+
+    size_t keep = lexer->filled - lexer->start;
+    memmove(lexer->buffer, lexer->buffer + lexer->start, keep);
+    lexer->base += (int64_t) lexer->start;
+    lexer->filled = keep;
+    lexer->start = 0;
+
+    if (!lexer->eof && lexer->filled < lexer->capacity) {
+        size_t wanted = lexer->capacity - lexer->filled;
+        size_t got = fread(lexer->buffer + lexer->filled, 1, wanted, lexer->input);
+        lexer->filled += got;
+        if (got < wanted) {
+            lexer->eof = 1;
+            lexer->failed = ferror(lexer->input) != 0;
+        }
+    }
+    lexer->buffer[lexer->filled] = '\0';
+}
+
+// Double the window, keeping what it holds. The lexer indexes the window with an
+// int, which bounds the growth. Returns 0 on success, -1 if it cannot grow.
+static int grow_window(StreamLexer *lexer) {
+    if (lexer->capacity > (INT_MAX - WINDOW_ALIGN) / 2) return -1;
+    char *buffer = allocate_window(lexer->capacity * 2);
+    if (!buffer) return -1;
+    memcpy(buffer, lexer->buffer, lexer->filled + 1);
+    free(lexer->buffer);
+    lexer->buffer = buffer;
+    lexer->capacity *= 2;
+    return 0;
+}
+
+// Whether the byte at window index i is the end of the data read so far rather
+// than a NUL in the input
+static int at_window_end(StreamLexer *lexer, size_t i) {
+    return i >= lexer->filled && !lexer->eof;
+}
+
+// Whether the UTF-8 character led by the byte at window index i would run past
+// the data read so far; decoding it looks ahead of where the lexer stops
+static int splits_character(StreamLexer *lexer, size_t i) {
+    unsigned char lead = (unsigned char) lexer->buffer[i];
+    size_t length = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+    return length > 1 && at_window_end(lexer, i + length - 1);
+}
+
+// Skip whitespace and comments the same way get_next_token() does, refilling the
+// window whenever a scan runs into its end
+static void skip_trivia(StreamLexer *lexer) {
+    for (;;) {
+        for (;;) {
+            const char *p = scan_whitespace(lexer->buffer + lexer->start);
+            lexer->start = (size_t) (p - lexer->buffer);
+            if (!at_window_end(lexer, lexer->start)) break;
+            refill(lexer);
+        }
+
+        // Deciding whether this is a comment takes two bytes
+        if (lexer->buffer[lexer->start] == '/' && at_window_end(lexer, lexer->start + 1)) refill(lexer);
+
+        const char *p = lexer->buffer + lexer->start;
+        if (p[0] == '/' && p[1] == '/') {
+            for (;;) {
+                lexer->start = (size_t) (scan_line_end(lexer->buffer + lexer->start) - lexer->buffer);
+                if (!at_window_end(lexer, lexer->start)) break;
+                refill(lexer);
+            }
+        } else if (p[0] == '/' && p[1] == '*') {
+            size_t body = lexer->start + 2;
+            lexer->start = body;
+            for (;;) {
+                p = scan_block_comment(lexer->buffer + lexer->start);
+                lexer->start = (size_t) (p - lexer->buffer);
+                if (*p != '\0') {
+                    lexer->start += 2;
+                    break;
+                }
+                if (!at_window_end(lexer, lexer->start)) break;
+
+                // A '*' right at the end of the window may be the first half of "*/"
+                if (lexer->start > body && lexer->buffer[lexer->start - 1] == '*') lexer->start--;
+                refill(lexer);
+                body = 0;
+            }
+        } else {
+            return;
+        }
+    }
+}
+
+StreamToken stream_next_token(StreamLexer *lexer) {
+    StreamToken result;
+    skip_trivia(lexer);
+
+    // Lex one token over the window. The DFA looks one byte past the lexeme (strings
+    // look up to the closing quote), so a token that reached the end of the window
+    // may continue in the input: slide it to the front, read more and lex it again.
+    Token token;
+    for (;;) {
+        char last_token_type = lexer->core.last_token_type;
+        lexer->core.source = lexer->buffer;
+        lexer->core.position = (int) lexer->start;
+        token = get_next_token(&lexer->core);
+
+        size_t end = (size_t) lexer->core.position;
+        if (!at_window_end(lexer, end) && !splits_character(lexer, end) &&
+            !splits_character(lexer, lexer->start)) {
+            break;
+        }
+        if (lexer->start == 0 && lexer->filled == lexer->capacity) {
+            // The token fills the window; only a string gets more room
+            int string = lexer->buffer[0] == '"' || lexer->buffer[0] == '\'';
+            if (!string || grow_window(lexer) != 0) {
+                token.type = TOKEN_ERROR;
+                token.error = string ? ERROR_STRING_TOO_LONG : ERROR_IDENTIFIER_TOO_LONG;
+                break;
+            }
+        }
+        lexer->core.last_token_type = last_token_type;
+        refill(lexer);
+    }
+
+    lexer->start = (size_t) lexer->core.position;
+
+    count_lines(lexer, (size_t) token.offset);
+    result.offset = lexer->base + token.offset;
+    result.line = lexer->line;
+    result.column = result.offset - lexer->line_start + 1;
+    result.token = token;
+    return result;
+}
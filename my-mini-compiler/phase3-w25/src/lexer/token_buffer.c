@@ -0,0 +1,46 @@
+/* token_buffer.c */
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/token_buffer.h"
+
+void token_buffer_init(TokenBuffer *tokens) {
+    memset(tokens, 0, sizeof(*tokens));
+}
+
+void token_buffer_free(TokenBuffer *tokens) {
+    free(tokens->type);
+    free(tokens->error);
+    free(tokens->offset);
+    free(tokens->length);
+    free(tokens->symbol);
+    free(tokens->number);
+    free(tokens->number_flags);
+    token_buffer_init(tokens);
+}
+
+// Grow one array to hold capacity entries of the given size
+static int grow(void *array, size_t size, uint32_t capacity) {
+    void *grown = realloc(*(void **) array, size * capacity);
+    if (!grown) return -1;
+    *(void **) array = grown;
+    return 0;
+}
+
+int token_buffer_reserve(TokenBuffer *tokens, uint32_t capacity) {
+    if (capacity <= tokens->capacity) return 0;
+
+    // Each array is resized on its own; on failure the ones already grown just
+    // have spare room, the buffer stays consistent at the old capacity
+    if (grow(&tokens->type, sizeof(*tokens->type), capacity) != 0 ||
+        grow(&tokens->error, sizeof(*tokens->error), capacity) != 0 ||
+        grow(&tokens->offset, sizeof(*tokens->offset), capacity) != 0 ||
+        grow(&tokens->length, sizeof(*tokens->length), capacity) != 0 ||
+        grow(&tokens->symbol, sizeof(*tokens->symbol), capacity) != 0 ||
+        grow(&tokens->number, sizeof(*tokens->number), capacity) != 0 ||
+        grow(&tokens->number_flags, sizeof(*tokens->number_flags), capacity) != 0) {
+        return -1;
+    }
+    tokens->capacity = capacity;
+    return 0;
+}
@@ -0,0 +1,160 @@
+/* token_dump.c */
+#include <string.h>
+
+#include "../../include/scan.h"
+#include "../../include/token_dump.h"
+
+// A varint is at most ten bytes; a token record at most four varints, a flags
+// byte and an eight byte value
+#define MAX_RECORD 49
+#define WRITE_BUFFER (64 * 1024)
+
+static uint8_t *put_varint(uint8_t *p, uint64_t value) {
+    while (value >= 0x80) {
+        *p++ = (uint8_t) (value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (uint8_t) value;
+    return p;
+}
+
+// Signed values map to unsigned so that small magnitudes stay short
+static uint64_t zigzag(int64_t value) {
+    return ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+}
+
+static int64_t unzigzag(uint64_t value) {
+    return (int64_t) (value >> 1) ^ -(int64_t) (value & 1);
+}
+
+int token_dump_write(FILE *out, const TokenBuffer *tokens, const char *source) {
+    uint8_t buffer[WRITE_BUFFER];
+    uint8_t *p = buffer;
+
+    memcpy(p, TOKEN_DUMP_MAGIC, 4);
+    p += 4;
+    *p++ = TOKEN_DUMP_VERSION;
+    p = put_varint(p, strlen(source));
+    p = put_varint(p, tokens->count);
+
+    uint64_t previous_end = 0;
+    uint64_t previous_offset = 0;
+    for (uint32_t i = 0; i < tokens->count; i++) {
+        if (p - buffer > WRITE_BUFFER - MAX_RECORD) {
+            if (fwrite(buffer, 1, (size_t) (p - buffer), out) != (size_t) (p - buffer)) return -1;
+            p = buffer;
+        }
+
+        uint64_t offset = tokens->offset[i];
+        p = put_varint(p, tokens->type[i] | (uint64_t) tokens->error[i] << 6);
+        p = put_varint(p, zigzag((int64_t) offset - (int64_t) previous_end));
+        p = put_varint(p, tokens->length[i]);
+        size_t newlines = 0;
+        if (offset > previous_offset) newlines = scan_newlines(source + previous_offset, offset - previous_offset, NULL);
+        p = put_varint(p, newlines);
+
+        if (tokens->type[i] == TOKEN_NUMBER) {
+            uint64_t value = tokens->number[i];
+            *p++ = tokens->number_flags[i];
+            if (tokens->number_flags[i] & NUMBER_DECIMAL) {
+                for (int b = 0; b < 8; b++) *p++ = (uint8_t) (value >> (8 * b));
+            } else {
+                p = put_varint(p, value);
+            }
+        }
+
+        previous_end = offset + tokens->length[i];
+        previous_offset = offset;
+    }
+
+    size_t size = (size_t) (p - buffer);
+    if (fwrite(buffer, 1, size, out) != size) return -1;
+    return fflush(out) == 0 ? 0 : -1;
+}
+
+// Returns 0 on success, -1 if the varint runs past the end or over 64 bits
+static int get_varint(TokenDumpReader *reader, uint64_t *value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (reader->next == reader->end) return -1;
+        uint8_t byte = *reader->next++;
+        result |= (uint64_t) (byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int token_dump_open(TokenDumpReader *reader, const void *data, size_t size) {
+    memset(reader, 0, sizeof(*reader));
+    reader->next = data;
+    reader->end = reader->next + size;
+    reader->line = 1;
+
+    uint64_t count;
+    if (size < 5 || memcmp(data, TOKEN_DUMP_MAGIC, 4) != 0 || reader->next[4] != TOKEN_DUMP_VERSION) return -1;
+    reader->next += 5;
+    if (get_varint(reader, &reader->source_size) != 0 || get_varint(reader, &count) != 0) return -1;
+    if (count > UINT32_MAX || reader->source_size > INT32_MAX) return -1;
+    reader->count = (uint32_t) count;
+    return 0;
+}
+
+int token_dump_next(TokenDumpReader *reader, Token *token, uint64_t *line) {
+    if (reader->index == reader->count) return 0;
+
+    uint64_t kind, gap, length, newlines;
+    if (get_varint(reader, &kind) != 0 || get_varint(reader, &gap) != 0 ||
+        get_varint(reader, &length) != 0 || get_varint(reader, &newlines) != 0) {
+        return -1;
+    }
+
+    // Offsets and lengths must stay inside the source the dump describes
+    int64_t offset = (int64_t) reader->previous_end + unzigzag(gap);
+    if (offset < 0 || (uint64_t) offset > reader->source_size || length > reader->source_size - (uint64_t) offset) {
+        return -1;
+    }
+
+    memset(token, 0, sizeof(*token));
+    token->type = (TokenType) (kind & 0x3F);
+    token->error = (ErrorType) (kind >> 6);
+    token->offset = (int) offset;
+    token->length = (int) length;
+
+    if (token->type == TOKEN_NUMBER) {
+        if (reader->next == reader->end) return -1;
+        token->number.flags = *reader->next++;
+        uint64_t value = 0;
+        if (token->number.flags & NUMBER_DECIMAL) {
+            if (reader->end - reader->next < 8) return -1;
+            for (int b = 0; b < 8; b++) value |= (uint64_t) *reader->next++ << (8 * b);
+        } else if (get_varint(reader, &value) != 0) {
+            return -1;
+        }
+        token->number.integer = (int64_t) value;
+    }
+
+    reader->line += newlines;
+    reader->previous_end = (uint64_t) offset + length;
+    reader->index++;
+    *line = reader->line;
+    return 1;
+}
+
+int token_dump_load(const void *data, size_t size, TokenBuffer *tokens) {
+    TokenDumpReader reader;
+    if (token_dump_open(&reader, data, size) != 0) return -1;
+    if (reader.count > UINT32_MAX - tokens->count || token_buffer_reserve(tokens, tokens->count + reader.count) != 0) {
+        return -1;
+    }
+
+    Token token;
+    uint64_t line;
+    int status;
+    while ((status = token_dump_next(&reader, &token, &line)) == 1) {
+        if (token_buffer_push(tokens, token) != 0) return -1;
+    }
+    return status;
+}
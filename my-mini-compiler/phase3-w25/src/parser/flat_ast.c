@@ -0,0 +1,154 @@
+/* flat_ast.c */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/flat_ast.h"
+
+void flat_ast_init(FlatAST *flat) {
+    memset(flat, 0, sizeof(*flat));
+    flat->root = FLAT_NONE;
+}
+
+void flat_ast_free(FlatAST *flat) {
+    free(flat->nodes);
+    flat_ast_init(flat);
+}
+
+// A node of the tree whose children are being laid out
+typedef struct {
+    const ASTNode *node;
+    uint32_t left; // Index of the left child once it is laid out
+    uint32_t state; // Binary nodes: 0 left child next, 1 right child next, 2 the node
+                    // itself next. Lists: index of the next item, count the node itself.
+} Frame;
+
+// Grow an array of entries of the given size so it holds at least count + 1
+static int reserve_one(void *array, uint32_t *capacity, uint32_t count, size_t size) {
+    if (count < *capacity) return 0;
+    if (*capacity > UINT32_MAX / 2) return -1;
+    uint32_t grown_capacity = *capacity ? *capacity * 2 : 1024;
+    void *grown = realloc(*(void **) array, size * grown_capacity);
+    if (!grown) return -1;
+    *(void **) array = grown;
+    *capacity = grown_capacity;
+    return 0;
+}
+
+// Append node with the given children; its subtree starts at first
+static int emit(FlatAST *flat, const ASTNode *node, uint32_t left, uint32_t right, uint32_t first) {
+    if (reserve_one(&flat->nodes, &flat->capacity, flat->count, sizeof(FlatNode)) != 0) return -1;
+    uint32_t index = flat->count++;
+    FlatNode *flat_node = &flat->nodes[index];
+    flat_node->type = node->type;
+    flat_node->op = node->op;
+    flat_node->token = node->token;
+    flat_node->left = left;
+    flat_node->right = right;
+    flat_node->first = first != FLAT_NONE ? first : index;
+    return 0;
+}
+
+int flat_ast_build(FlatAST *flat, const ASTNode *root) {
+    flat->count = 0;
+    flat->root = FLAT_NONE;
+    if (!root) return 0;
+
+    Frame *stack = NULL;
+    uint32_t depth = 0, stack_capacity = 0;
+    uint32_t last = FLAT_NONE; // Index of the subtree laid out last, FLAT_NONE for a missing child
+
+    if (reserve_one(&stack, &stack_capacity, depth, sizeof(Frame)) != 0) return -1;
+    stack[depth++] = (Frame) {root, FLAT_NONE, 0};
+
+    while (depth > 0) {
+        Frame *frame = &stack[depth - 1];
+        const ASTNode *node = frame->node;
+        const ASTNode *child = NULL;
+        int done = 0;
+        if (ast_is_list(node->type)) {
+            if (frame->state < node->count) {
+                if (frame->state == 0) frame->left = flat->count; // Where the first item starts
+                child = node->items[frame->state++];
+            } else {
+                // Items have no links of their own; right is the last one
+                done = emit(flat, node, FLAT_NONE, node->count ? last : FLAT_NONE, frame->left) == 0 ? 1 : -1;
+            }
+        } else if (frame->state == 0) {
+            child = node->left;
+            frame->state = 1;
+        } else if (frame->state == 1) {
+            frame->left = last;
+            child = node->right;
+            frame->state = 2;
+        } else {
+            uint32_t first = frame->left != FLAT_NONE ? flat->nodes[frame->left].first
+                             : last != FLAT_NONE ? flat->nodes[last].first
+                             : FLAT_NONE;
+            done = emit(flat, node, frame->left, last, first) == 0 ? 1 : -1;
+        }
+
+        if (done < 0 || (child && reserve_one(&stack, &stack_capacity, depth, sizeof(Frame)) != 0)) {
+            free(stack);
+            return -1;
+        }
+        if (done) {
+            last = flat->count - 1;
+            depth--;
+        } else if (child) {
+            stack[depth++] = (Frame) {child, FLAT_NONE, 0};
+        } else {
+            last = FLAT_NONE;
+        }
+    }
+
+    free(stack);
+    flat->root = flat->count - 1;
+    return 0;
+}
+
+static const char *const node_names[] = {
+    [AST_PROGRAM] = "Program",
+    [AST_VARDECL] = "VarDecl",
+    [AST_ASSIGN] = "Assign",
+    [AST_PRINT] = "Print",
+    [AST_NUMBER] = "Number",
+    [AST_IDENTIFIER] = "Identifier",
+    [AST_IF] = "If",
+    [AST_WHILE] = "While",
+    [AST_REPEAT] = "RepeatUntil",
+    [AST_BLOCK] = "Block",
+    [AST_FACTORIAL] = "Factorial",
+    [AST_ADDRESS_OF] = "AddressOf",
+    [AST_BINOP] = "BinaryOperation",
+    [AST_COMPARISONOP] = "ComparisonOperation",
+    [AST_BOOLOP] = "BooleanOperation",
+    [AST_FUNCDECL] = "FunctionDeclare",
+    [AST_PARAM] = "FunctionParameter",
+    [AST_PARAM_LIST] = "FunctionParameters"
+};
+
+// Print a child index, '-' for a missing child
+static void print_index(uint32_t index) {
+    if (index == FLAT_NONE) {
+        printf(" -");
+    } else {
+        printf(" %u", index);
+    }
+}
+
+void print_flat_ast(CompilerContext *ctx, const FlatAST *flat) {
+    for (uint32_t i = 0; i < flat->count; i++) {
+        const FlatNode *node = &flat->nodes[i];
+        char lexeme[100];
+        token_lexeme(flat_ast_token(ctx, node), ctx->lexer.source, lexeme, sizeof(lexeme));
+
+        const char *name = node->type < sizeof(node_names) / sizeof(node_names[0]) && node_names[node->type]
+                               ? node_names[node->type]
+                               : "Unknown";
+        printf("%u: %s '%s'", i, name, lexeme);
+        print_index(node->left);
+        print_index(node->right);
+        printf("\n");
+    }
+}
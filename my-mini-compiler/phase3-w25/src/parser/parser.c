@@ -4,6 +4,8 @@
 #include <string.h>
 #include "../../include/lexer.h"
 #include "../../include/parser.h"
+#include "../../include/parallel_lexer.h"
+#include "../../include/pipelined_lexer.h"
 
 
 // TODO 1: Add more parsing function declarations for:
@@ -14,138 +16,277 @@
 // - blocks: { statement1; statement2; }
 // - factorial function: factorial(x)
 //------------------------------------------------------------------------------------------------------------------------Added code under
-static ASTNode *parse_if_statement(void);
+static ASTNode *parse_if_statement(CompilerContext *ctx);
 
-static ASTNode *parse_while_statement(void);
+static ASTNode *parse_while_statement(CompilerContext *ctx);
 
-static ASTNode *parse_repeat_statement(void);
+static ASTNode *parse_repeat_statement(CompilerContext *ctx);
 
-static ASTNode *parse_print_statement(void);
+static ASTNode *parse_print_statement(CompilerContext *ctx);
 
-static ASTNode *parse_block(void);
+static ASTNode *parse_block(CompilerContext *ctx);
 
-static ASTNode *parse_factorial(void);
+static ASTNode *parse_factorial(CompilerContext *ctx);
 
-static ASTNode *parse_functions(void);
+static ASTNode *parse_functions(CompilerContext *ctx);
 
 //------------------------------------------------------------------------------------------------------------------------Added code above
 
-// Current token being processed
-static Token current_token;
-static int position = 0;
-static const char *source;
-
-static void parse_error(ParseError error, Token token) {
+static void parse_error(CompilerContext *ctx, ParseError error, Token token) {
     // TODO 2: Add more error types for:
     // - Missing parentheses
     // - Missing condition
     // - Missing block braces
     // - Invalid operator
     // - Function call errors
+    char lexeme[100];
+    char detail[200];
+    token_lexeme(token, ctx->lexer.source, lexeme, sizeof(lexeme));
 
-    printf("Parse Error at line %d: ", token.line);
     switch (error) {
         case PARSE_ERROR_UNEXPECTED_TOKEN:
-            printf("Unexpected token '%s'\n", token.lexeme);
+            snprintf(detail, sizeof(detail), "Unexpected token '%s'", lexeme);
             break;
         case PARSE_ERROR_MISSING_SEMICOLON:
-            printf("Missing semicolon after '%s'\n", token.lexeme);
+            snprintf(detail, sizeof(detail), "Missing semicolon after '%s'", lexeme);
             break;
         case PARSE_ERROR_MISSING_IDENTIFIER:
-            printf("Expected identifier after '%s'\n", token.lexeme);
+            snprintf(detail, sizeof(detail), "Expected identifier after '%s'", lexeme);
             break;
         case PARSE_ERROR_MISSING_EQUALS:
-            printf("Expected '=' after '%s'\n", token.lexeme);
+            snprintf(detail, sizeof(detail), "Expected '=' after '%s'", lexeme);
             break;
         case PARSE_ERROR_INVALID_EXPRESSION:
-            printf("Invalid expression after '%s'\n", token.lexeme);
+            snprintf(detail, sizeof(detail), "Invalid expression after '%s'", lexeme);
             break;
         //------------------------------------------------------------------------------------------------------------------------Added code under
         case PARSE_ERROR_MISSING_PARENTHESIS:
-            printf("Missing parenthesis after '%s'\n", token.lexeme);
+            snprintf(detail, sizeof(detail), "Missing parenthesis after '%s'", lexeme);
             break;
         case PARSE_ERROR_MISSING_CONDITION:
-            printf("Missing condition after '%s'\n", token.lexeme);
+            snprintf(detail, sizeof(detail), "Missing condition after '%s'", lexeme);
             break;
         case PARSE_ERROR_MISSING_BLOCK_BRACES:
-            printf("Missing block braces after '%s'\n", token.lexeme);
+            snprintf(detail, sizeof(detail), "Missing block braces after '%s'", lexeme);
             break;
         case PARSE_ERROR_INVALID_OPERATOR:
-            printf("Invalid operator: '%s'\n", token.lexeme);
+            snprintf(detail, sizeof(detail), "Invalid operator: '%s'", lexeme);
             break;
         case PARSE_ERROR_FUNCTION_CALL_ERROR:
-            printf("Invalid function call '%s'\n", token.lexeme);
+            snprintf(detail, sizeof(detail), "Invalid function call '%s'", lexeme);
             break;
         case PARSE_ERROR_UNDECLARED_VARIABLE:
-            printf("Variable '%s' is not declared in scope\n", token.lexeme);
+            snprintf(detail, sizeof(detail), "Variable '%s' is not declared in scope", lexeme);
+            break;
+        case PARSE_ERROR_NESTING_TOO_DEEP:
+            snprintf(detail, sizeof(detail), "Nesting deeper than %u levels at '%s', skipped",
+                     ctx->parser.max_depth, lexeme);
             break;
         //------------------------------------------------------------------------------------------------------------------------Added code above
         default:
-            printf("Unknown error\n");
+            snprintf(detail, sizeof(detail), "Unknown error");
+    }
+    SourceLocation location = source_locate(&ctx->source_map, (uint32_t) token.offset);
+    report_diagnostic(ctx, "Parse Error at line %d, column %d: %s", location.line, location.column, detail);
+}
+
+// Pull the tokens the lexer thread has produced since the last call into the
+// token buffer. Returns 0 once no more are coming; by then the lexer thread has
+// been joined and the lexer state is final.
+static int fetch_tokens(CompilerContext *ctx) {
+    LexPipeline *pipeline = ctx->parser.pipeline;
+    if (!pipeline) return 0;
+
+    int read = lex_pipeline_read(pipeline, &ctx->parser.tokens);
+    if (read > 0) return 1;
+    ctx->parser.pipeline = NULL;
+    if (lex_pipeline_finish(pipeline) != 0 || read < 0) {
+        report_diagnostic(ctx, "Out of memory after %u tokens, parsing stops there", ctx->parser.tokens.count);
+    }
+    return 0;
+}
+
+// Type of the token n places after the one being processed, which is peek(ctx, 0).
+// Lookahead is just an index into the token buffer, so every token is still lexed
+// once however far the parser looks. Past the end of the stream everything reads as EOF.
+static inline TokenType peek(CompilerContext *ctx, uint32_t n) {
+    uint32_t index = ctx->parser.current + n;
+    while (index >= ctx->parser.tokens.count) {
+        if (!fetch_tokens(ctx)) return TOKEN_EOF;
+    }
+    return (TokenType) ctx->parser.tokens.type[index];
+}
+
+// Type of the token being processed
+static inline TokenType current_type(CompilerContext *ctx) {
+    return peek(ctx, 0);
+}
+
+// The token being processed, reassembled from the token buffer
+static Token current_token(CompilerContext *ctx) {
+    if (current_type(ctx) == TOKEN_EOF && ctx->parser.current >= ctx->parser.tokens.count) {
+        Token eof = {.type = TOKEN_EOF, .offset = (int) ctx->lexer.position, .error = ERROR_NONE};
+        return eof;
+    }
+    return token_at(&ctx->parser.tokens, ctx->parser.current);
+}
+
+// Get next token; the parser stays on the final EOF token once it reaches it
+static void advance(CompilerContext *ctx) {
+    while (ctx->parser.current + 1 >= ctx->parser.tokens.count) {
+        if (!fetch_tokens(ctx)) return;
     }
+    ctx->parser.current++;
 }
 
-// Get next token
-static void advance(void) {
-    current_token = get_next_token(source, &position);
+// Associate the token being processed with a node
+static void set_token(CompilerContext *ctx, ASTNode *node) {
+    node->op = (uint8_t) current_type(ctx);
+    node->token = ctx->parser.current;
 }
 
-// Create a new AST node
-static ASTNode *create_node(ASTNodeType type) {
-    ASTNode *node = malloc(sizeof(ASTNode));
+// Create a new AST node; it lives in the context's arena until context_free()
+static ASTNode *create_node(CompilerContext *ctx, ASTNodeType type) {
+    ASTNode *node = ARENA_NEW(&ctx->ast, ASTNode);
     if (node) {
-        node->type = type;
-        node->token = current_token;
+        node->type = (uint8_t) type;
+        set_token(ctx, node);
         node->left = NULL;
         node->right = NULL;
     }
     return node;
 }
 
+// Push an item of the innermost list being parsed; missing items (NULL after a
+// parse error) are left out
+static void push_item(CompilerContext *ctx, ASTNode *item) {
+    ParserState *parser = &ctx->parser;
+    if (!item) return;
+    if (parser->item_count == parser->item_capacity) {
+        uint32_t capacity = parser->item_capacity ? parser->item_capacity * 2 : 256;
+        ASTNode **items = parser->item_capacity <= UINT32_MAX / 2
+                              ? realloc(parser->items, (size_t) capacity * sizeof(*items))
+                              : NULL;
+        if (!items) {
+            report_diagnostic(ctx, "Out of memory after %u list items, some are left out", parser->item_count);
+            return;
+        }
+        parser->items = items;
+        parser->item_capacity = capacity;
+    }
+    parser->items[parser->item_count++] = item;
+}
+
+// Move the items pushed since start into the list node's own array in the arena
+static void finish_list(CompilerContext *ctx, ASTNode *list, uint32_t start) {
+    ParserState *parser = &ctx->parser;
+    uint32_t count = parser->item_count - start;
+    parser->item_count = start;
+    if (!list || count == 0) return;
+
+    list->items = arena_alloc(&ctx->ast, count * sizeof(ASTNode *), _Alignof(ASTNode *));
+    if (!list->items) {
+        report_diagnostic(ctx, "Out of memory after %u list items, some are left out", start);
+        return;
+    }
+    memcpy(list->items, parser->items + start, count * sizeof(ASTNode *));
+    list->count = count;
+}
+
 // Match current token with expected type
-static int match(TokenType type) {
-    return current_token.type == type;
+static int match(CompilerContext *ctx, TokenType type) {
+    return current_type(ctx) == type;
 }
 
 // Function to handle errors such that it skips ahead so it can resume parsing to allow for more errors to be collected at once.
-static void error_recovery() {
+static void error_recovery(CompilerContext *ctx) {
     // Skip tokens until a safe point is found.
-    while (current_token.type != TOKEN_EOF) {
-        if (match(TOKEN_SEMICOLON)) {
-            advance();
+    while (current_type(ctx) != TOKEN_EOF) {
+        if (match(ctx, TOKEN_SEMICOLON)) {
+            advance(ctx);
             break;
         }
-        // Check if current token is the beginning of a new statement.
-        if (current_token.type == TOKEN_INT ||
-            current_token.type == TOKEN_CHAR ||
-            current_token.type == TOKEN_FLOAT ||
-            current_token.type == TOKEN_DOUBLE ||
-            current_token.type == TOKEN_STRING ||
-            current_token.type == TOKEN_IF ||
-            current_token.type == TOKEN_WHILE ||
-            current_token.type == TOKEN_REPEAT ||
-            current_token.type == TOKEN_PRINT ||
-            current_token.type == TOKEN_IDENTIFIER ||
-            current_token.type == TOKEN_LBRACE) {
+        // Check if current token is the beginning of a new statement. Only stop at
+        // tokens parse_statement() consumes, or a caller that retries there never advances.
+        if (current_type(ctx) == TOKEN_INT ||
+            current_type(ctx) == TOKEN_IF ||
+            current_type(ctx) == TOKEN_WHILE ||
+            current_type(ctx) == TOKEN_REPEAT ||
+            current_type(ctx) == TOKEN_PRINT ||
+            current_type(ctx) == TOKEN_IDENTIFIER ||
+            current_type(ctx) == TOKEN_LBRACE) {
             break;
         }
-        advance();
+        advance(ctx);
     }
 }
 
+// Skip the parenthesized or braced region starting at the token being processed,
+// up to and including its closing token; nothing is skipped unless that token opens one
+static void skip_nested(CompilerContext *ctx) {
+    uint32_t open = 0;
+    do {
+        TokenType type = current_type(ctx);
+        if (type == TOKEN_EOF) return;
+        if (type == TOKEN_LPAREN || type == TOKEN_LBRACE) {
+            open++;
+        } else if (open == 0) {
+            return; // Not at an opening token
+        } else if (type == TOKEN_RPAREN || type == TOKEN_RBRACE) {
+            open--;
+        }
+        advance(ctx);
+    } while (open > 0);
+}
+
+// Skip the statement body starting at the token being processed: everything up to
+// and including the next ';' outside parentheses or the first braced region, which
+// ends the body. Stops before a '}', which closes an enclosing block.
+static void skip_body(CompilerContext *ctx) {
+    for (;;) {
+        TokenType type = current_type(ctx);
+        if (type == TOKEN_EOF || type == TOKEN_RBRACE) return;
+        if (type == TOKEN_LPAREN || type == TOKEN_LBRACE) {
+            skip_nested(ctx);
+            if (type == TOKEN_LBRACE) return;
+            continue;
+        }
+        advance(ctx);
+        if (type == TOKEN_SEMICOLON) return;
+    }
+}
+
+// Enter one more level of parentheses, blocks or statement bodies. Past
+// ctx->parser.max_depth the region is reported once and skipped, and 0 is returned;
+// the caller then parses nothing. Otherwise the caller leaves the level with
+// ctx->parser.depth--.
+static int enter_nesting(CompilerContext *ctx) {
+    if (ctx->parser.depth >= ctx->parser.max_depth) {
+        parse_error(ctx, PARSE_ERROR_NESTING_TOO_DEEP, current_token(ctx));
+        if (match(ctx, TOKEN_LPAREN)) {
+            skip_nested(ctx);
+        } else {
+            skip_body(ctx);
+        }
+        return 0;
+    }
+    ctx->parser.depth++;
+    return 1;
+}
+
 // Expect a token type or error
-static void expect(TokenType type) {
-    if (match(type)) {
-        advance();
+static void expect(CompilerContext *ctx, TokenType type) {
+    if (match(ctx, type)) {
+        advance(ctx);
     } else {
-        parse_error(PARSE_ERROR_UNEXPECTED_TOKEN, current_token);
-        error_recovery();
+        parse_error(ctx, PARSE_ERROR_UNEXPECTED_TOKEN, current_token(ctx));
+        error_recovery(ctx);
     }
 }
 
 // Forward declarations
-// static ASTNode *parse_statement(void);
-// static ASTNode *parse_expression(void);
+// static ASTNode *parse_statement(CompilerContext *ctx);
+// static ASTNode *parse_expression(CompilerContext *ctx);
 
 // TODO 3: Add parsing functions for each new statement type
 // static ASTNode* parse_if_statement(void) { ... }
@@ -156,172 +297,171 @@ static void expect(TokenType type) {
 // static ASTNode* parse_factorial(void) { ... }
 
 //------------------------------------------------------------------------------------------------------------------------Added code under
-static ASTNode *parse_if_statement(void) {
-    advance(); // consume 'if'
-    expect(TOKEN_LPAREN);
-    ASTNode *condition = parse_bool();
-    expect(TOKEN_RPAREN);
-    ASTNode *body = parse_block();
-
-    ASTNode *node = create_node(AST_IF);
+static ASTNode *parse_if_statement(CompilerContext *ctx) {
+    advance(ctx); // consume 'if'
+    expect(ctx, TOKEN_LPAREN);
+    ASTNode *condition = parse_expression(ctx);
+    expect(ctx, TOKEN_RPAREN);
+    ASTNode *body = parse_block(ctx);
+
+    ASTNode *node = create_node(ctx, AST_IF);
     node->left = condition;
     node->right = body;
     return node;
 }
 
-static ASTNode *parse_while_statement(void) {
-    advance(); // consume 'while'
-    expect(TOKEN_LPAREN);
-    ASTNode *condition = parse_bool();
-    expect(TOKEN_RPAREN);
-    ASTNode *body = parse_block();
+static ASTNode *parse_while_statement(CompilerContext *ctx) {
+    advance(ctx); // consume 'while'
+    expect(ctx, TOKEN_LPAREN);
+    ASTNode *condition = parse_expression(ctx);
+    expect(ctx, TOKEN_RPAREN);
+    ASTNode *body = parse_block(ctx);
 
-    ASTNode *node = create_node(AST_WHILE);
+    ASTNode *node = create_node(ctx, AST_WHILE);
     node->left = condition;
     node->right = body;
     return node;
 }
 
-static ASTNode *parse_repeat_statement(void) {
-    advance(); // consume 'repeat'
-    ASTNode *body = parse_block();
-    expect(TOKEN_UNTIL);
-    expect(TOKEN_LPAREN);
-    ASTNode *condition = parse_bool();
-    expect(TOKEN_RPAREN);
+static ASTNode *parse_repeat_statement(CompilerContext *ctx) {
+    advance(ctx); // consume 'repeat'
+    ASTNode *body = parse_block(ctx);
+    expect(ctx, TOKEN_UNTIL);
+    expect(ctx, TOKEN_LPAREN);
+    ASTNode *condition = parse_expression(ctx);
+    expect(ctx, TOKEN_RPAREN);
 
-    ASTNode *node = create_node(AST_REPEAT);
+    ASTNode *node = create_node(ctx, AST_REPEAT);
     node->left = body;
     node->right = condition;
     return node;
 }
 
-static ASTNode *parse_print_statement(void) {
-    advance(); // consume 'print'
-    ASTNode *expr = parse_bool();
-    expect(TOKEN_SEMICOLON);
+static ASTNode *parse_print_statement(CompilerContext *ctx) {
+    advance(ctx); // consume 'print'
+    ASTNode *expr = parse_expression(ctx);
+    expect(ctx, TOKEN_SEMICOLON);
 
-    ASTNode *node = create_node(AST_PRINT);
+    ASTNode *node = create_node(ctx, AST_PRINT);
     node->left = expr;
     return node;
 }
 
-static ASTNode *parse_block(void) {
+static ASTNode *parse_block(CompilerContext *ctx) {
     // printf("test");
-    expect(TOKEN_LBRACE);
+    // Every body is a level, braced or not: without a '{' (reported by expect() below)
+    // the body's statements still nest, as in a chain of 'if (a) if (a) ...'
+    if (!enter_nesting(ctx)) return NULL;
+    expect(ctx, TOKEN_LBRACE);
 
-    ASTNode *block = create_node(AST_BLOCK);
-    ASTNode *current = block;
+    ASTNode *block = create_node(ctx, AST_BLOCK);
+    uint32_t start = ctx->parser.item_count;
 
-    while (!match(TOKEN_RBRACE) && current_token.type != TOKEN_EOF) {
-        current->left = parse_statement();
-        if (!match(TOKEN_RBRACE)) {
-            current->right = create_node(AST_BLOCK);
-            current = current->right;
-        }
+    while (!match(ctx, TOKEN_RBRACE) && current_type(ctx) != TOKEN_EOF) {
+        push_item(ctx, parse_statement(ctx));
     }
+    finish_list(ctx, block, start);
 
-    expect(TOKEN_RBRACE);
+    expect(ctx, TOKEN_RBRACE);
+    ctx->parser.depth--;
     return block;
 }
 
-static ASTNode *parse_factorial(void) {
-    advance(); // consume '!'
-    expect(TOKEN_LPAREN);
-    ASTNode *arg = parse_bool();
-    expect(TOKEN_RPAREN);
-    expect(TOKEN_SEMICOLON);
+static ASTNode *parse_factorial(CompilerContext *ctx) {
+    advance(ctx); // consume '!'
+    expect(ctx, TOKEN_LPAREN);
+    ASTNode *arg = parse_expression(ctx);
+    expect(ctx, TOKEN_RPAREN);
+    expect(ctx, TOKEN_SEMICOLON);
 
-    ASTNode *node = create_node(AST_FACTORIAL);
+    ASTNode *node = create_node(ctx, AST_FACTORIAL);
     node->left = arg;
     return node;
 }
 
-static ASTNode *parse_parameters(void) {
-    if (!match(TOKEN_INT)) {
-        parse_error(PARSE_ERROR_UNEXPECTED_TOKEN, current_token);
-        error_recovery();
+static ASTNode *parse_parameters(CompilerContext *ctx) {
+    if (!match(ctx, TOKEN_INT)) {
+        parse_error(ctx, PARSE_ERROR_UNEXPECTED_TOKEN, current_token(ctx));
+        error_recovery(ctx);
         return NULL;
     }
 
-    ASTNode *param = create_node(AST_PARAM);
-    param->token = current_token; // store the type (int)
-    advance(); // consume type
+    ASTNode *param = create_node(ctx, AST_PARAM);
+    set_token(ctx, param); // store the type (int)
+    advance(ctx); // consume type
 
     // Handle parameter name
-    if (!match(TOKEN_IDENTIFIER)) {
-        parse_error(PARSE_ERROR_MISSING_IDENTIFIER, current_token);
-        error_recovery();
+    if (!match(ctx, TOKEN_IDENTIFIER)) {
+        parse_error(ctx, PARSE_ERROR_MISSING_IDENTIFIER, current_token(ctx));
+        error_recovery(ctx);
         return NULL;
     }
 
     // Create identifier node for parameter name
-    ASTNode *identifier = create_node(AST_IDENTIFIER);
-    identifier->token = current_token;
+    ASTNode *identifier = create_node(ctx, AST_IDENTIFIER);
+    set_token(ctx, identifier);
     param->left = identifier;
 
 
-    advance(); // consume identifier
+    advance(ctx); // consume identifier
     return param;
 }
 
-static ASTNode *parse_functions(void) {
-    ASTNode *node = create_node(AST_FUNCDECL);
-    advance(); // consume 'int' or whatever return type
+static ASTNode *parse_functions(CompilerContext *ctx) {
+    ASTNode *node = create_node(ctx, AST_FUNCDECL);
+    advance(ctx); // consume 'int' or whatever return type
 
-    if (!match(TOKEN_IDENTIFIER)) {
-        parse_error(PARSE_ERROR_MISSING_IDENTIFIER, current_token);
-        error_recovery();
+    if (!match(ctx, TOKEN_IDENTIFIER)) {
+        parse_error(ctx, PARSE_ERROR_MISSING_IDENTIFIER, current_token(ctx));
+        error_recovery(ctx);
         return NULL;
     }
 
     // Store function name
-    node->token = current_token;
-    advance(); // consume function name
+    set_token(ctx, node);
+    advance(ctx); // consume function name
 
     // Parse parameters
-    if (!match(TOKEN_LPAREN)) {
-        parse_error(PARSE_ERROR_MISSING_PARENTHESIS, current_token);
-        error_recovery();
+    if (!match(ctx, TOKEN_LPAREN)) {
+        parse_error(ctx, PARSE_ERROR_MISSING_PARENTHESIS, current_token(ctx));
+        error_recovery(ctx);
         return NULL;
     }
-    advance(); // consume '('
+    advance(ctx); // consume '('
 
     ASTNode *parameter_list = NULL;
-    ASTNode *current_param = NULL;
 
     // Parse parameter list until ')' is reachedd
-    if (!match(TOKEN_RPAREN)) {
-        parameter_list = create_node(AST_BLOCK); // Use block type for parameter list
-        current_param = parameter_list;
+    if (!match(ctx, TOKEN_RPAREN)) {
+        parameter_list = create_node(ctx, AST_PARAM_LIST);
+        uint32_t start = ctx->parser.item_count;
 
         do {
-            current_param->left = parse_parameters();
+            push_item(ctx, parse_parameters(ctx));
 
-            // Check if there are more parameters and create new node fo next parameter
-            if (match(TOKEN_COMMA)) {
-                advance(); // Consume comma
-                current_param->right = create_node(AST_BLOCK);
-                current_param = current_param->right;
+            // Check if there are more parameters
+            if (match(ctx, TOKEN_COMMA)) {
+                advance(ctx); // Consume comma
             }
-        } while (match(TOKEN_INT) && !match(TOKEN_EOF));
+        } while (match(ctx, TOKEN_INT) && !match(ctx, TOKEN_EOF));
+        finish_list(ctx, parameter_list, start);
     }
 
-    if (!match(TOKEN_RPAREN)) {
-        parse_error(PARSE_ERROR_MISSING_PARENTHESIS, current_token);
-        error_recovery();
+    if (!match(ctx, TOKEN_RPAREN)) {
+        parse_error(ctx, PARSE_ERROR_MISSING_PARENTHESIS, current_token(ctx));
+        error_recovery(ctx);
         return NULL;
     }
-    advance(); // consume ')'
+    advance(ctx); // consume ')'
     node->right = parameter_list;
 
     // Parse function body
-    if (match(TOKEN_LBRACE)) {
+    if (match(ctx, TOKEN_LBRACE)) {
         // Must access to parameters in body as they're in the same or parent scope
-        node->left = parse_block();
+        node->left = parse_block(ctx);
     } else {
-        parse_error(PARSE_ERROR_MISSING_BLOCK_BRACES, current_token);
-        error_recovery();
+        parse_error(ctx, PARSE_ERROR_MISSING_BLOCK_BRACES, current_token(ctx));
+        error_recovery(ctx);
         return NULL;
     }
 
@@ -331,84 +471,66 @@ static ASTNode *parse_functions(void) {
 //------------------------------------------------------------------------------------------------------------------------Added code above
 
 // Parse variable declaration: int x;
-static ASTNode *parse_declaration(void) {
-    ASTNode *node = create_node(AST_VARDECL);
-    advance(); // consume 'int'
+static ASTNode *parse_declaration(CompilerContext *ctx) {
+    ASTNode *node = create_node(ctx, AST_VARDECL);
+    advance(ctx); // consume 'int'
 
-    if (!match(TOKEN_IDENTIFIER)) {
-        parse_error(PARSE_ERROR_MISSING_IDENTIFIER, current_token);
-        error_recovery();
+    if (!match(ctx, TOKEN_IDENTIFIER)) {
+        parse_error(ctx, PARSE_ERROR_MISSING_IDENTIFIER, current_token(ctx));
+        error_recovery(ctx);
         return NULL;
     }
 
-    node->token = current_token;
-    advance();
+    set_token(ctx, node);
+    advance(ctx);
 
-    if (!match(TOKEN_SEMICOLON)) {
-        parse_error(PARSE_ERROR_MISSING_SEMICOLON, current_token);
-        error_recovery();
+    if (!match(ctx, TOKEN_SEMICOLON)) {
+        parse_error(ctx, PARSE_ERROR_MISSING_SEMICOLON, current_token(ctx));
+        error_recovery(ctx);
         return NULL;
     }
-    advance();
+    advance(ctx);
     return node;
 }
 
 // Parse assignment: x = 5;
-static ASTNode *parse_assignment(void) {
-    ASTNode *node = create_node(AST_ASSIGN);
-    node->left = create_node(AST_IDENTIFIER);
-    node->left->token = current_token;
-
-    advance();
-    if (!match(TOKEN_ASSIGN)) {
-        parse_error(PARSE_ERROR_MISSING_EQUALS, current_token);
-        error_recovery();
+static ASTNode *parse_assignment(CompilerContext *ctx) {
+    ASTNode *node = create_node(ctx, AST_ASSIGN);
+    node->left = create_node(ctx, AST_IDENTIFIER);
+    set_token(ctx, node->left);
+
+    advance(ctx);
+    if (!match(ctx, TOKEN_ASSIGN)) {
+        parse_error(ctx, PARSE_ERROR_MISSING_EQUALS, current_token(ctx));
+        error_recovery(ctx);
         return NULL;
     }
 
-    advance();
-    node->right = parse_bool();
+    advance(ctx);
+    node->right = parse_expression(ctx);
 
-    if (!match(TOKEN_SEMICOLON)) {
-        parse_error(PARSE_ERROR_MISSING_SEMICOLON, current_token);
-        error_recovery();
+    if (!match(ctx, TOKEN_SEMICOLON)) {
+        parse_error(ctx, PARSE_ERROR_MISSING_SEMICOLON, current_token(ctx));
+        error_recovery(ctx);
         return NULL;
     }
 
-    advance();
+    advance(ctx);
     return node;
 }
 
 // Parse statement
-static ASTNode *parse_statement(void) {
+static ASTNode *parse_statement(CompilerContext *ctx) {
     // if (match(TOKEN_INT)) {
     //     return parse_declaration();
-    if (match(TOKEN_INT)) {
-        // Need to "peak" here to see if this is a variable or function declaration, thus save state variables to be reloaded positions later
-        Token saved_token = current_token;
-        int saved_position = position;
-
-        advance(); // consume 'int'
-
-        if (match(TOKEN_IDENTIFIER)) {
-            advance(); // consume identifier
-
-            if (match(TOKEN_LPAREN)) {
-                current_token = saved_token;
-                position = saved_position;
-                return parse_functions();
-            } else {
-                current_token = saved_token;
-                position = saved_position;
-                return parse_declaration();
-            }
-        } else {
-            current_token = saved_token;
-            position = saved_position;
-            return parse_declaration(); // continue but invalid identifier
+    if (match(ctx, TOKEN_INT)) {
+        // Peek past 'int' and the name to tell a function from a variable declaration
+        if (peek(ctx, 1) == TOKEN_IDENTIFIER && peek(ctx, 2) == TOKEN_LPAREN) {
+            return parse_functions(ctx);
         }
-    } else if (match(TOKEN_IDENTIFIER)) {
-        return parse_assignment();
+        return parse_declaration(ctx); // continue even with an invalid identifier
+    } else if (match(ctx, TOKEN_IDENTIFIER)) {
+        return parse_assignment(ctx);
     }
     // TODO 4: Add cases for new statement types
     // else if (match(TOKEN_IF)) return parse_if_statement();
@@ -417,21 +539,21 @@ static ASTNode *parse_statement(void) {
     // else if (match(TOKEN_PRINT)) return parse_print_statement();
     // ...
     //------------------------------------------------------------------------------------------------------------------------Added code under
-    else if (match(TOKEN_IF)) {
-        return parse_if_statement();
-    } else if (match(TOKEN_WHILE)) {
-        return parse_while_statement();
-    } else if (match(TOKEN_REPEAT)) {
-        return parse_repeat_statement();
-    } else if (match(TOKEN_PRINT)) {
-        return parse_print_statement();
-    } else if (match(TOKEN_FACTORIAL)) {
-        return parse_factorial();
-    } else if (match(TOKEN_LBRACE)) {
-        return parse_block();
+    else if (match(ctx, TOKEN_IF)) {
+        return parse_if_statement(ctx);
+    } else if (match(ctx, TOKEN_WHILE)) {
+        return parse_while_statement(ctx);
+    } else if (match(ctx, TOKEN_REPEAT)) {
+        return parse_repeat_statement(ctx);
+    } else if (match(ctx, TOKEN_PRINT)) {
+        return parse_print_statement(ctx);
+    } else if (match(ctx, TOKEN_FACTORIAL)) {
+        return parse_factorial(ctx);
+    } else if (match(ctx, TOKEN_LBRACE)) {
+        return parse_block(ctx);
     } else {
-        parse_error(PARSE_ERROR_UNEXPECTED_TOKEN, current_token);
-        error_recovery();
+        parse_error(ctx, PARSE_ERROR_UNEXPECTED_TOKEN, current_token(ctx));
+        error_recovery(ctx);
         return NULL;
     }
 }
@@ -447,165 +569,157 @@ static ASTNode *parse_statement(void) {
 // - Function calls
 //------------------------------------------------------------------------------------------------------------------------Added code below
 
-static ASTNode *parse_primary(void) {
-    if (match(TOKEN_NUMBER)) {
-        ASTNode *node = create_node(AST_NUMBER);
-        advance();
+static ASTNode *parse_primary(CompilerContext *ctx) {
+    if (match(ctx, TOKEN_NUMBER)) {
+        ASTNode *node = create_node(ctx, AST_NUMBER);
+        advance(ctx);
         return node;
-    } else if (match(TOKEN_IDENTIFIER)) {
-        ASTNode *node = create_node(AST_IDENTIFIER);
-        advance();
+    } else if (match(ctx, TOKEN_IDENTIFIER)) {
+        ASTNode *node = create_node(ctx, AST_IDENTIFIER);
+        advance(ctx);
         return node;
-    } else if (match(TOKEN_LPAREN)) {
-        advance();
-        ASTNode *expr = parse_bool();
-        expect(TOKEN_RPAREN);
+    } else if (match(ctx, TOKEN_LPAREN)) {
+        if (!enter_nesting(ctx)) return NULL;
+        advance(ctx);
+        ASTNode *expr = parse_expression(ctx);
+        expect(ctx, TOKEN_RPAREN);
+        ctx->parser.depth--;
         return expr;
     } else {
-        parse_error(PARSE_ERROR_INVALID_EXPRESSION, current_token);
-        error_recovery();
+        parse_error(ctx, PARSE_ERROR_INVALID_EXPRESSION, current_token(ctx));
+        error_recovery(ctx);
         return NULL;
     }
 }
 
-// Handles OR boolean
-static ASTNode *parse_bool(void) {
-    ASTNode *node = parse_join();
-    while (match(TOKEN_OR)) {
-        ASTNode *opNode = create_node(AST_BOOLOP);
-        opNode->token = current_token;
-        advance();
-        opNode->left = node;
-        opNode->right = parse_join();
-        node = opNode;
-    }
-    return node;
-}
-
-// Handles AND boolean
-static ASTNode *parse_join(void) {
-    ASTNode *node = parse_equality();
-    while (match(TOKEN_AND)) {
-        ASTNode *opNode = create_node(AST_BOOLOP);
-        opNode->token = current_token;
-        advance();
-        opNode->left = node;
-        opNode->right = parse_equality();
-        node = opNode;
-    }
-    return node;
-}
-
-// Handles == and !=
-static ASTNode *parse_equality(void) {
-    ASTNode *node = parse_relational();
-    while (match(TOKEN_EQ) || match(TOKEN_NEQ)) {
-        ASTNode *opNode = create_node(AST_COMPARISONOP);
-        opNode->token = current_token;
-        advance();
-        opNode->left = node;
-        opNode->right = parse_relational();
-        node = opNode;
-    }
-    return node;
-}
-
-// Handles > and <
-static ASTNode *parse_relational(void) {
-    ASTNode *node = parse_expression();
-    while (match(TOKEN_LT) || match(TOKEN_GT)) {
-        ASTNode *opNode = create_node(AST_COMPARISONOP);
-        opNode->token = current_token;
-        advance();
+// Binary operators by token type: binding power (0 for tokens that are not
+// binary operators) and the node built for them. A higher power binds tighter;
+// every level is left-associative.
+typedef struct {
+    uint8_t power;
+    uint8_t node; // ASTNodeType
+} BinaryOperator;
+
+static const BinaryOperator binary_operators[TOKEN_KEYWORD + 1] = {
+    [TOKEN_OR] = {1, AST_BOOLOP},
+    [TOKEN_AND] = {2, AST_BOOLOP},
+    [TOKEN_EQ] = {3, AST_COMPARISONOP},
+    [TOKEN_NEQ] = {3, AST_COMPARISONOP},
+    [TOKEN_LT] = {4, AST_COMPARISONOP},
+    [TOKEN_GT] = {4, AST_COMPARISONOP},
+    [TOKEN_PLUS] = {5, AST_BINOP},
+    [TOKEN_MINUS] = {5, AST_BINOP},
+    [TOKEN_STAR] = {6, AST_BINOP},
+    [TOKEN_SLASH] = {6, AST_BINOP}
+};
+
+// Precedence climbing: parse an operand, then every operator that binds at least
+// min_power, each with a right operand of the operators binding tighter than it
+static ASTNode *parse_binary(CompilerContext *ctx, int min_power) {
+    ASTNode *node = parse_unary(ctx);
+    for (;;) {
+        BinaryOperator op = binary_operators[current_type(ctx)];
+        if (op.power < min_power) break; // min_power is at least 1, so non-operators stop here
+
+        ASTNode *opNode = create_node(ctx, (ASTNodeType) op.node);
+        advance(ctx);
         opNode->left = node;
-        opNode->right = parse_expression();
+        opNode->right = parse_binary(ctx, op.power + 1);
         node = opNode;
     }
     return node;
 }
 
-// Handles + and -
-static ASTNode *parse_expression(void) {
-    ASTNode *node = parse_term();
-    while (match(TOKEN_PLUS) || match(TOKEN_MINUS)) {
-        ASTNode *opNode = create_node(AST_BINOP);
-        opNode->token = current_token;
-        advance();
-        opNode->left = node;
-        opNode->right = parse_term();
-        node = opNode;
-    }
-    return node;
-}
-
-// Handles * and /
-static ASTNode *parse_term(void) {
-    ASTNode *node = parse_unary();
-    while (match(TOKEN_STAR) || match(TOKEN_SLASH)) {
-        ASTNode *opNode = create_node(AST_BINOP);
-        opNode->token = current_token;
-        advance();
-        opNode->left = node;
-        opNode->right = parse_unary();
-        node = opNode;
-    }
-    return node;
+// Parse a whole expression, down to the loosest operator (||)
+static ASTNode *parse_expression(CompilerContext *ctx) {
+    return parse_binary(ctx, 1);
 }
 
 // Handles factorial
-static ASTNode *parse_unary(void) {
-    if (match(TOKEN_FACTORIAL)) {
-        ASTNode *opNode = create_node(AST_FACTORIAL);
-        opNode->token = current_token;
-        advance();
-        opNode->right = parse_primary();
+static ASTNode *parse_unary(CompilerContext *ctx) {
+    if (match(ctx, TOKEN_FACTORIAL)) {
+        ASTNode *opNode = create_node(ctx, AST_FACTORIAL);
+        set_token(ctx, opNode);
+        advance(ctx);
+        opNode->right = parse_primary(ctx);
         return opNode;
-    } else if (match(TOKEN_ADDRESS)) {
-        ASTNode *opNode = create_node(AST_ADDRESS_OF);
-        opNode->token = current_token;
-        advance();
-        opNode->right = parse_primary();
+    } else if (match(ctx, TOKEN_ADDRESS)) {
+        ASTNode *opNode = create_node(ctx, AST_ADDRESS_OF);
+        set_token(ctx, opNode);
+        advance(ctx);
+        opNode->right = parse_primary(ctx);
         return opNode;
     }
-    return parse_primary();
+    return parse_primary(ctx);
 }
 
 //------------------------------------------------------------------------------------------------------------------------Added code above
 
 // Parse program (multiple statements)
-static ASTNode *parse_program(void) {
-    ASTNode *program = create_node(AST_PROGRAM);
-    ASTNode *current = program;
-
-    while (!match(TOKEN_EOF)) {
-        current->left = parse_statement();
-        if (!match(TOKEN_EOF)) {
-            current->right = create_node(AST_PROGRAM);
-            current = current->right;
-        }
+static ASTNode *parse_program(CompilerContext *ctx) {
+    ASTNode *program = create_node(ctx, AST_PROGRAM);
+    uint32_t start = ctx->parser.item_count;
+
+    while (!match(ctx, TOKEN_EOF)) {
+        push_item(ctx, parse_statement(ctx));
     }
+    finish_list(ctx, program, start);
 
     return program;
 }
 
+// Reset the parser state for a new input
+static void parser_reset(CompilerContext *ctx, const char *input) {
+    if (ctx->parser.pipeline) lex_pipeline_finish(ctx->parser.pipeline);
+    ctx->parser.pipeline = NULL;
+    lexer_init(&ctx->lexer, input);
+    ctx->lexer.interns = &ctx->interns;
+    source_map_free(&ctx->source_map);
+    source_map_init(&ctx->source_map, input);
+    ctx->parser.tokens.count = 0;
+    ctx->parser.current = 0;
+    ctx->parser.item_count = 0;
+    ctx->parser.depth = 0;
+}
+
 // Initialize parser
-void parser_init(const char *input) {
-    source = input;
-    position = 0;
-    advance(); // Get first token
+void parser_init(CompilerContext *ctx, const char *input) {
+    parser_reset(ctx, input);
+    // Large inputs are lexed on all CPUs, small ones sequentially
+    if (lex_all_parallel(&ctx->lexer, &ctx->parser.tokens, 0) != 0) {
+        report_diagnostic(ctx, "Out of memory after %u tokens, parsing stops there", ctx->parser.tokens.count);
+    }
+}
+
+void parser_init_pipelined(CompilerContext *ctx, const char *input) {
+    parser_reset(ctx, input);
+    ctx->parser.pipeline = lex_pipeline_start(&ctx->lexer);
+    if (!ctx->parser.pipeline) {
+        parser_init(ctx, input);
+    }
 }
 
 // Main parse function
-ASTNode *parse(void) {
-    return parse_program();
+ASTNode *parse(CompilerContext *ctx) {
+    ASTNode *program = parse_program(ctx);
+    // Drain the pipeline so the lexer and intern table are settled for later phases
+    while (fetch_tokens(ctx)) {
+    }
+    return program;
 }
 
-// Print AST (for debugging)
-void print_ast(ASTNode *node, int level) {
-    if (!node) return;
+#define PRINT_MAX_INDENT 256
+
+// Print one AST node, without its children
+static void print_ast_node(CompilerContext *ctx, ASTNode *node, int level) {
+    char lexeme[100];
+    token_lexeme(ast_token(ctx, node), ctx->lexer.source, lexeme, sizeof(lexeme));
 
-    // Indent based on level
-    for (int i = 0; i < level; i++) printf("  ");
+    // Indent based on level; past PRINT_MAX_INDENT levels the rest is shown as a
+    // number, so a long operator chain does not print quadratically many spaces
+    int indent = level < PRINT_MAX_INDENT ? level : PRINT_MAX_INDENT;
+    printf("%*s", indent * 2, "");
+    if (level > indent) printf("+%d ", level - indent);
 
     // Print node info
     switch (node->type) {
@@ -613,16 +727,16 @@ void print_ast(ASTNode *node, int level) {
             printf("Program\n");
             break;
         case AST_VARDECL:
-            printf("VarDecl: %s\n", node->token.lexeme);
+            printf("VarDecl: %s\n", lexeme);
             break;
         case AST_ASSIGN:
             printf("Assign\n");
             break;
         case AST_NUMBER:
-            printf("Number: %s\n", node->token.lexeme);
+            printf("Number: %s\n", lexeme);
             break;
         case AST_IDENTIFIER:
-            printf("Identifier: %s\n", node->token.lexeme);
+            printf("Identifier: %s\n", lexeme);
             break;
         // TODO 6: Add cases for new node types
         // case AST_IF: printf("If\n"); break;
@@ -650,47 +764,92 @@ void print_ast(ASTNode *node, int level) {
             printf("Factorial\n");
             break;
         case AST_BINOP:
-            printf("BinaryOperation: %s\n", node->token.lexeme);
+            printf("BinaryOperation: %s\n", lexeme);
             break;
         case AST_COMPARISONOP:
-            printf("ComaprisonOperation: %s\n", node->token.lexeme);
+            printf("ComaprisonOperation: %s\n", lexeme);
             break;
         case AST_BOOLOP:
-            printf("BooleanOperation: %s\n", node->token.lexeme);
+            printf("BooleanOperation: %s\n", lexeme);
             break;
         case AST_FUNCDECL:
-            printf("FunctionDeclare: %s\n", node->token.lexeme);
+            printf("FunctionDeclare: %s\n", lexeme);
             break;
         case AST_PARAM:
-            printf("FunctionParameter: %s\n", node->token.lexeme);
+            printf("FunctionParameter: %s\n", lexeme);
+            break;
+        case AST_PARAM_LIST:
+            printf("FunctionParameters\n");
             break;
         //------------------------------------------------------------------------------------------------------------------------Added code above
         default:
             printf("Unknown AST node type\n");
     }
-
-    // Print children
-    print_ast(node->left, level + 1);
-    print_ast(node->right, level + 1);
 }
 
-// Free AST memory
-void free_ast(ASTNode *node) {
-    if (!node) return;
-    free_ast(node->left);
-    free_ast(node->right);
-    free(node);
+// A node waiting to be printed by print_ast()
+typedef struct {
+    ASTNode *node;
+    int level;
+} PrintFrame;
+
+// Print AST (for debugging). The walk keeps its pending nodes on the heap: nesting
+// is bounded by ctx->parser.max_depth, but a chain like a + a + ... + a is as deep
+// as it is long.
+void print_ast(CompilerContext *ctx, ASTNode *node, int level) {
+    PrintFrame *stack = NULL;
+    size_t depth = 0, capacity = 0;
+
+    while (node || depth > 0) {
+        if (!node) {
+            depth--;
+            node = stack[depth].node;
+            level = stack[depth].level;
+            continue;
+        }
+        print_ast_node(ctx, node, level);
+
+        // Push the children to print after this one, last first, and go on with the first
+        ASTNode *first = node->left;
+        size_t pending = ast_is_list(node->type) ? node->count : node->right != NULL;
+        if (depth + pending > capacity) {
+            size_t grown = capacity ? capacity * 2 : 256;
+            if (grown < depth + pending) grown = depth + pending;
+            PrintFrame *frames = realloc(stack, grown * sizeof(*frames));
+            if (!frames) {
+                printf("(out of memory, AST printout truncated)\n");
+                break;
+            }
+            stack = frames;
+            capacity = grown;
+        }
+        if (ast_is_list(node->type)) {
+            first = node->count ? node->items[0] : NULL;
+            for (uint32_t i = node->count; i > 1; i--) {
+                stack[depth++] = (PrintFrame) {node->items[i - 1], level + 1};
+            }
+        } else if (node->right) {
+            stack[depth++] = (PrintFrame) {node->right, level + 1};
+        }
+        node = first;
+        level++;
+    }
+    free(stack);
 }
 
 // Example of examining tokens
 void print_token_stream(const char *input) {
-    int position = 0;
+    Lexer lexer;
+    SourceMap map;
     Token token;
 
+    lexer_init(&lexer, input);
+    source_map_init(&map, input);
     do {
-        token = get_next_token(input, &position);
-        print_token(token);
+        token = get_next_token(&lexer);
+        print_token(token, input, source_locate(&map, (uint32_t) token.offset));
     } while (token.type != TOKEN_EOF);
+    source_map_free(&map);
 }
 
 // Main function for testing
@@ -711,12 +870,14 @@ void print_token_stream(const char *input) {
 //    ;
 //
 //    printf("Parsing input:\n%s\n", invalid_input);
-//    parser_init(invalid_input);
-//    ASTNode *ast = parse();
+//    CompilerContext ctx;
+//    context_init(&ctx);
+//    parser_init(&ctx, invalid_input);
+//    ASTNode *ast = parse(&ctx);
 //
 //    printf("\nAbstract Syntax Tree:\n");
-//    print_ast(ast, 0);
+//    print_ast(&ctx, ast, 0);
 //
-//    free_ast(ast);
+//    context_free(&ctx);
 //    return 0;
 //}
@@ -2,32 +2,38 @@
 #include <string.h>
 #include <stdio.h>
 
+#include "../../include/lexer.h"
 #include "../../include/parser.h"
 #include "../../include/semantic.h"
 
 // =============== BEGIN STEP 4 ===============
-void semantic_error(SemanticErrorType error, const char *name, int line) {
-    printf("Semantic Error at line %d: ", line);
+void semantic_error(CompilerContext *ctx, SemanticErrorType error, const char *name, int offset) {
+    char detail[200];
 
     switch (error) {
         case SEM_ERROR_UNDECLARED_VARIABLE:
-            printf("Undeclared variable '%s'\n", name);
+            snprintf(detail, sizeof(detail), "Undeclared variable '%s'", name);
             break;
         case SEM_ERROR_REDECLARED_VARIABLE:
-            printf("Variable '%s' already declared in this scope\n", name);
+            snprintf(detail, sizeof(detail), "Variable '%s' already declared in this scope", name);
             break;
         case SEM_ERROR_TYPE_MISMATCH:
-            printf("Type mismatch involving '%s'\n", name);
+            snprintf(detail, sizeof(detail), "Type mismatch involving '%s'", name);
             break;
         case SEM_ERROR_UNINITIALIZED_VARIABLE:
-            printf("Variable '%s' may be used uninitialized\n", name);
+            snprintf(detail, sizeof(detail), "Variable '%s' may be used uninitialized", name);
             break;
         case SEM_ERROR_INVALID_OPERATION:
-            printf("Invalid operation involving '%s'\n", name);
+            snprintf(detail, sizeof(detail), "Invalid operation involving '%s'", name);
+            break;
+        case SEM_ERROR_NUMBER_OUT_OF_RANGE:
+            snprintf(detail, sizeof(detail), "Number '%s' is out of range", name);
             break;
         default:
-            printf("Unknown semantic error with '%s'\n", name);
+            snprintf(detail, sizeof(detail), "Unknown semantic error with '%s'", name);
     }
+    SourceLocation location = source_locate(&ctx->source_map, (uint32_t) offset);
+    report_diagnostic(ctx, "Semantic Error at line %d, column %d: %s", location.line, location.column, detail);
 }
 
 // =============== END STEP 4 ===============
@@ -44,16 +50,17 @@ SymbolTable *init_symbol_table() {
     return table;
 }
 
-void symbol_table_dump(SymbolTable *table) {
+void symbol_table_dump(CompilerContext *ctx, SymbolTable *table) {
     printf("== SYMBOL TABLE DUMP ==\n");
     printf("Total symbols: %lu\n\n", sizeof(*table) / sizeof(table[0]));
     unsigned int index = 0;
     Symbol *current_symbol = table->head;
     while (current_symbol != NULL) {
         printf("\tSymbol[%u]\n", index);
-        printf("\tName: %s\n", current_symbol->name);
+        printf("\tName: %s\n", intern_name(&ctx->interns, current_symbol->name));
         printf("\tType: %d\n", current_symbol->type);
-        printf("\tLine Declared: %d\n", current_symbol->line_declared);
+        SourceLocation declared = source_locate(&ctx->source_map, (uint32_t) current_symbol->offset_declared);
+        printf("\tLine Declared: %d\n", declared.line);
         if (current_symbol->is_initialized) {
             printf("\tInitialized: Yes\n");
         } else {
@@ -66,14 +73,14 @@ void symbol_table_dump(SymbolTable *table) {
 }
 
 // Add a symbol to the table
-// Inserts a new variable with given name, type, and line number into the current scope
-void add_symbol(SymbolTable *table, const char *name, int type, int line) {
+// Inserts a new variable with given name, type, and source offset into the current scope
+void add_symbol(SymbolTable *table, uint32_t name, int type, int offset) {
     Symbol *symbol = malloc(sizeof(Symbol));
     if (symbol) {
-        strcpy(symbol->name, name);
+        symbol->name = name;
         symbol->type = type;
         symbol->scope_level = table->current_scope;
-        symbol->line_declared = line;
+        symbol->offset_declared = offset;
         symbol->is_initialized = 0;
 
         // Add to beginning of list
@@ -96,12 +103,12 @@ void add_symbol(SymbolTable *table, const char *name, int type, int line) {
 //     return NULL;
 // }
 
-Symbol *lookup_symbol(SymbolTable *table, const char *name) {
+Symbol *lookup_symbol(SymbolTable *table, uint32_t name) {
     Symbol *current = table->head;
     Symbol *best_match = NULL;
 
     while (current) {
-        if (strcmp(current->name, name) == 0) {
+        if (current->name == name) {
             if (current->scope_level <= table->current_scope) {
                 best_match = current;
             }
@@ -112,10 +119,10 @@ Symbol *lookup_symbol(SymbolTable *table, const char *name) {
 }
 
 // Look up symbol in current scope only
-Symbol *lookup_symbol_current_scope(SymbolTable *table, const char *name) {
+Symbol *lookup_symbol_current_scope(SymbolTable *table, uint32_t name) {
     Symbol *current = table->head;
     while (current) {
-        if (strcmp(current->name, name) == 0 &&
+        if (current->name == name &&
             current->scope_level == table->current_scope) {
             return current;
         }
@@ -181,52 +188,48 @@ void free_symbol_table(SymbolTable *table) {
 // =============== BEGIN STEP 3 ===============
 
 // Analyze AST semantically
-int analyze_semantics(ASTNode *ast) {
+int analyze_semantics(CompilerContext *ctx, ASTNode *ast) {
     SymbolTable *table = init_symbol_table();
-    int result = check_program(ast, table);
+    int result = check_program(ctx, ast, table);
     if (result)
-        symbol_table_dump(table);
+        symbol_table_dump(ctx, table);
     free_symbol_table(table);
     return result;
 }
 
 // Check program node
-int check_program(ASTNode *node, SymbolTable *table) {
+int check_program(CompilerContext *ctx, ASTNode *node, SymbolTable *table) {
     if (!node) return 1;
 
     int result = 1;
 
     if (node->type == AST_PROGRAM) {
-        // Check left child (statement)
-        if (node->left) {
-            result = check_statement(node->left, table) && result;
-        }
-
-        // Check right child (rest of program)
-        if (node->right) {
-            result = check_program(node->right, table) && result;
+        // Check every statement, even after one fails
+        for (uint32_t i = 0; i < node->count; i++) {
+            result = check_statement(ctx, node->items[i], table) && result;
         }
     }
     return result;
 }
 
 // Check declaration node
-int check_declaration(ASTNode *node, SymbolTable *table) {
+int check_declaration(CompilerContext *ctx, ASTNode *node, SymbolTable *table) {
     if (node->type != AST_VARDECL) {
         return 0;
     }
 
-    const char *name = node->token.lexeme;
-
     // Check if variable already declared in current scope
-    Symbol *existing = lookup_symbol_current_scope(table, name);
+    Token token = ast_token(ctx, node);
+    Symbol *existing = lookup_symbol_current_scope(table, token.symbol);
     if (existing) {
-        semantic_error(SEM_ERROR_REDECLARED_VARIABLE, name, node->token.line);
+        char lexeme[100];
+        token_lexeme(token, ctx->lexer.source, lexeme, sizeof(lexeme));
+        semantic_error(ctx, SEM_ERROR_REDECLARED_VARIABLE, lexeme, token.offset);
         return 0;
     }
 
     // Add to symbol table
-    add_symbol(table, name, TOKEN_INT, node->token.line);
+    add_symbol(table, token.symbol, TOKEN_INT, token.offset);
     return 1;
 }
 
@@ -236,32 +239,39 @@ int check_declaration(ASTNode *node, SymbolTable *table) {
 //     return 1;
 // }
 
-int check_statement(ASTNode *node, SymbolTable *table) {
+int check_statement(CompilerContext *ctx, ASTNode *node, SymbolTable *table) {
     if (!node) return 1;
 
     if (node->type == AST_IF || node->type == AST_WHILE) {
-        return check_expression(node->left, table) && check_statement(node->right, table);
+        return check_expression(ctx, node->left, table) && check_statement(ctx, node->right, table);
     } else if (node->type == AST_BLOCK) {
+        // The block's statements share one scope; checking stops at the first that fails
         enter_scope(table);
-        int result = check_statement(node->left, table) && check_statement(node->right, table);
+        int result = 1;
+        for (uint32_t i = 0; i < node->count && result; i++) {
+            result = check_statement(ctx, node->items[i], table);
+        }
         exit_scope(table);
         return result;
     } else if (node->type == AST_VARDECL) {
-        return check_declaration(node, table);
+        return check_declaration(ctx, node, table);
     } else if (node->type == AST_ASSIGN) {
-        return check_assignment(node, table);
+        return check_assignment(ctx, node, table);
     } else if (node->type == AST_PRINT) {
-        const char *name = node->left->token.lexeme;
-        Symbol *symbol = lookup_symbol(table, name);
+        if (!node->left) return 1; // No expression; the parser reported it
+        Token name = ast_token(ctx, node->left);
+        Symbol *symbol = lookup_symbol(table, name.symbol);
         if (!symbol) {
-            semantic_error(SEM_ERROR_UNDECLARED_VARIABLE, name, node->token.line);
+            char lexeme[100];
+            token_lexeme(name, ctx->lexer.source, lexeme, sizeof(lexeme));
+            semantic_error(ctx, SEM_ERROR_UNDECLARED_VARIABLE, lexeme, ast_token(ctx, node).offset);
             return 0;
         }
     }
     return 1;
 }
 
-int check_type_compatability(ASTNode *node, SymbolTable *table) {
+int check_type_compatability(CompilerContext *ctx, ASTNode *node, SymbolTable *table) {
     ASTNode *left = node->left;
     ASTNode *right = node->right;
     if (!left || !right) {
@@ -280,7 +290,7 @@ int check_type_compatability(ASTNode *node, SymbolTable *table) {
             Symbol *right_symbol;
 
             if (left->type == AST_IDENTIFIER) {
-                left_symbol = lookup_symbol(table, left->token.lexeme);
+                left_symbol = lookup_symbol(table, ast_token(ctx, left).symbol);
                 if (right->type == AST_NUMBER &&
                     (left_symbol->type == TOKEN_INT || left_symbol->type == TOKEN_FLOAT || left_symbol->type ==
                      TOKEN_CHAR || left_symbol->type == TOKEN_DOUBLE)) {
@@ -289,7 +299,7 @@ int check_type_compatability(ASTNode *node, SymbolTable *table) {
             }
 
             if (right->type == AST_IDENTIFIER) {
-                right_symbol = lookup_symbol(table, right->token.lexeme);
+                right_symbol = lookup_symbol(table, ast_token(ctx, right).symbol);
                 if (left->type == AST_NUMBER &&
                     (right_symbol->type == TOKEN_INT || right_symbol->type == TOKEN_FLOAT || right_symbol->type ==
                      TOKEN_CHAR || right_symbol->type == TOKEN_DOUBLE)) {
@@ -303,62 +313,119 @@ int check_type_compatability(ASTNode *node, SymbolTable *table) {
     }
 }
 
-int check_expression(ASTNode *node, SymbolTable *table) {
+// Check one expression node, not its operands
+static int check_expression_node(CompilerContext *ctx, ASTNode *node, SymbolTable *table) {
     switch (node->type) {
-        case AST_NUMBER:
+        case AST_NUMBER: {
+            Token token = ast_token(ctx, node);
+            if (token.number.flags & NUMBER_OVERFLOW) {
+                char lexeme[100];
+                token_lexeme(token, ctx->lexer.source, lexeme, sizeof(lexeme));
+                semantic_error(ctx, SEM_ERROR_NUMBER_OUT_OF_RANGE, lexeme, token.offset);
+                return 0;
+            }
             return 1;
+        }
         case AST_IDENTIFIER: {
-            const char *name = node->token.lexeme;
+            Token token = ast_token(ctx, node);
+            char name[100];
+            token_lexeme(token, ctx->lexer.source, name, sizeof(name));
             // Lookup the symbol of the current variable in the statement
-            Symbol *existing = lookup_symbol(table, name);
+            Symbol *existing = lookup_symbol(table, token.symbol);
             // Check if it exists
             if (!existing) {
-                semantic_error(SEM_ERROR_UNDECLARED_VARIABLE, name, node->token.line);
+                semantic_error(ctx, SEM_ERROR_UNDECLARED_VARIABLE, name, token.offset);
                 return 0;
             } else {
                 if (!existing->is_initialized) {
-                    semantic_error(SEM_ERROR_UNINITIALIZED_VARIABLE, name, node->token.line);
+                    semantic_error(ctx, SEM_ERROR_UNINITIALIZED_VARIABLE, name, token.offset);
                     return 0;
                 }
             }
             return 1;
         }
         case AST_FACTORIAL:
-            break;
         case AST_ADDRESS_OF:
-            break;
+            return 1;
         case AST_BINOP:
         case AST_COMPARISONOP:
         case AST_BOOLOP: {
-            if (!check_type_compatability(node, table)) {
-                semantic_error(SEM_ERROR_TYPE_MISMATCH, node->token.lexeme, node->token.line);
+            if (!check_type_compatability(ctx, node, table)) {
+                Token token = ast_token(ctx, node);
+                char lexeme[100];
+                token_lexeme(token, ctx->lexer.source, lexeme, sizeof(lexeme));
+                semantic_error(ctx, SEM_ERROR_TYPE_MISMATCH, lexeme, token.offset);
             }
-            return check_expression(node->left, table) && check_expression(node->right, table);
+            return 1;
         }
         case AST_FUNCDECL:
-            break;
+            return 1;
         default:
             return 0;
     }
 }
 
+// Checks the node before its left operand and that before its right one, and stops
+// at the first that fails, as `left && right` at every operator would. The operands
+// waiting to be checked are kept on the heap: a chain like a + a + ... + a is as
+// deep as it is long.
+int check_expression(CompilerContext *ctx, ASTNode *node, SymbolTable *table) {
+    ASTNode **stack = NULL;
+    size_t depth = 0, capacity = 0;
+    int result = 1;
+
+    while (node || depth > 0) {
+        if (!node) { // Missing after a parse error, which was reported already
+            node = stack[--depth];
+            continue;
+        }
+        if (!check_expression_node(ctx, node, table)) {
+            result = 0;
+            break;
+        }
+
+        int binary = node->type == AST_BINOP || node->type == AST_COMPARISONOP || node->type == AST_BOOLOP;
+        if (!binary) {
+            node = NULL;
+            continue;
+        }
+        if (depth == capacity) {
+            size_t grown = capacity ? capacity * 2 : 256;
+            ASTNode **nodes = realloc(stack, grown * sizeof(*nodes));
+            if (!nodes) {
+                report_diagnostic(ctx, "Out of memory while checking an expression");
+                result = 0;
+                break;
+            }
+            stack = nodes;
+            capacity = grown;
+        }
+        stack[depth++] = node->right;
+        node = node->left;
+    }
+    free(stack);
+    return result;
+}
+
 // Check assignment node
-int check_assignment(ASTNode *node, SymbolTable *table) {
+int check_assignment(CompilerContext *ctx, ASTNode *node, SymbolTable *table) {
     if (node->type != AST_ASSIGN || !node->left || !node->right) {
         return 0;
     }
 
-    const char *name = node->left->token.lexeme;
+    Token name = ast_token(ctx, node->left);
 
     // Check if variable exists
-    Symbol *symbol = lookup_symbol(table, name);
+    Symbol *symbol = lookup_symbol(table, name.symbol);
     if (!symbol) {
-        semantic_error(SEM_ERROR_UNDECLARED_VARIABLE, name, node->token.line);
+        char lexeme[100];
+        token_lexeme(name, ctx->lexer.source, lexeme, sizeof(lexeme));
+        semantic_error(ctx, SEM_ERROR_UNDECLARED_VARIABLE, lexeme, ast_token(ctx, node).offset);
         return 0;
     }
 
     // Check expression
-    int expr_valid = check_expression(node->right, table);
+    int expr_valid = check_expression(ctx, node->right, table);
 
     // Mark as initialized
     if (expr_valid) {
@@ -369,49 +436,3 @@ int check_assignment(ASTNode *node, SymbolTable *table) {
 }
 
 // =============== END STEP 3 ===============
-
-int main() {
-    const char *input =
-            "x = 42;\n"
-            "if (x > y) {\n"
-            "    int y;\n"
-            "    y = z + 10;\n"
-            "    print y;\n"
-            "}\n";
-
-    // const char *input =
-    //         "// Uninitialized variable\n"
-    //         "int x;\n"
-    //         "int y;\n"
-    //         "y = x + 5; // Warning: x used before initialization\n";
-    //"print y;";
-
-    // const char *input = "int x;\n"
-    //         "x = 42;\n"
-    //         "y = 45;\n";
-
-    printf("Analyzing input:\n%s\n", input);
-
-    // Lexical analysis and parsing
-    parser_init(input);
-    ASTNode *ast = parse();
-
-    printf("\nAbstract Syntax Tree:\n");
-    print_ast(ast, 0);
-
-    printf("AST created. Performing semantic analysis...\n\n");
-
-    // Semantic analysis
-    int result = analyze_semantics(ast);
-
-    if (result) {
-        printf("Semantic analysis successful. No errors found.\n");
-    } else {
-        printf("Semantic analysis failed. Errors detected.\n");
-    }
-
-    // Clean up
-    free_ast(ast);
-
-    return 0;
-}
@@ -0,0 +1,77 @@
+/* lexer_scaling_test.c */
+// Scaling test for identifier lexing: the work per identifier must not grow with
+// its length. Built with LEXER_COUNT_KEYWORD_LOOKUPS, so the lexer counts its
+// keyword lookups; lexing identifiers from 16 bytes to 64 KB long must take at
+// most one lookup of the whole word and one per prefix up to the longest keyword.
+// A prefix check over every prefix would take one per byte.
+//
+//     lexer_scaling_test
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../include/lexer.h"
+#include "keywords.h" // For KEYWORD_MAX_LENGTH
+
+#define SIZE (2 << 20)
+
+extern unsigned long lexer_keyword_lookups;
+
+// About size bytes of identifiers of the given length, one per line. They start
+// with 'x', which no keyword does, so every one of them is a valid identifier.
+static char *identifiers(size_t size, size_t length, long *count) {
+    *count = (long) (size / (length + 1));
+    char *text = malloc(*count * (length + 1) + 1);
+    if (!text) {
+        fprintf(stderr, "out of memory\n");
+        exit(2);
+    }
+    char *p = text;
+    for (long i = 0; i < *count; i++) {
+        *p++ = 'x';
+        for (size_t j = 1; j < length; j++) *p++ = (char) ('a' + (i + j) % 26);
+        *p++ = '\n';
+    }
+    *p = '\0';
+    return text;
+}
+
+static int failures;
+
+// Lex identifiers of the given length with get_next_token and check the count of
+// identifiers found and of keyword lookups made
+static void check_length(size_t length) {
+    long expected;
+    char *input = identifiers(SIZE, length, &expected);
+
+    Lexer lexer;
+    Token token;
+    long found = 0;
+    lexer_keyword_lookups = 0;
+    lexer_init(&lexer, input);
+    do {
+        token = get_next_token(&lexer);
+        found += token.type == TOKEN_IDENTIFIER;
+    } while (token.type != TOKEN_EOF);
+    free(input);
+
+    double per_identifier = (double) lexer_keyword_lookups / (double) expected;
+    fprintf(stderr, "%zu-byte identifiers: %.2f keyword lookups each\n", length, per_identifier);
+    if (found != expected) {
+        fprintf(stderr, "FAIL %zu-byte identifiers: %ld found, expected %ld\n", length, found, expected);
+        failures++;
+    }
+    if (lexer_keyword_lookups > (unsigned long) expected * (KEYWORD_MAX_LENGTH + 1)) {
+        fprintf(stderr, "FAIL %zu-byte identifiers: %lu keyword lookups, expected at most %ld\n", length,
+                lexer_keyword_lookups, expected * (KEYWORD_MAX_LENGTH + 1));
+        failures++;
+    }
+}
+
+int main(void) {
+    static const size_t lengths[] = {16, 256, 4096, 65536};
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) check_length(lengths[i]);
+
+    if (failures) return 1;
+    fprintf(stderr, "lexer scaling: ok\n");
+    return 0;
+}
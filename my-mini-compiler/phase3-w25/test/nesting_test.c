@@ -0,0 +1,209 @@
+/* nesting_test.c */
+// Regression tests for pathological nesting: a million levels of parentheses, of
+// blocks and of brace-less if, while and repeat bodies, a million-term operator
+// chain, and a stray '}' at the depth limit.
+// Each input is parsed, printed and checked on the default native stack; a crash
+// fails the test as surely as a wrong diagnostic does.
+//
+//     nesting_test <parens | blocks | if | while | repeat | chain | unclosed | stray>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/flat_ast.h"
+#include "../include/parser.h"
+#include "../include/semantic.h"
+
+#define DEPTH 1000000
+
+// Growable source text
+typedef struct {
+    char *data;
+    size_t length;
+    size_t capacity;
+} Text;
+
+static void append(Text *text, const char *piece, size_t times) {
+    size_t length = strlen(piece);
+    if (text->length + length * times + 1 > text->capacity) {
+        size_t capacity = (text->length + length * times + 1) * 2;
+        char *data = realloc(text->data, capacity);
+        if (!data) {
+            fprintf(stderr, "out of memory\n");
+            exit(2);
+        }
+        text->data = data;
+        text->capacity = capacity;
+    }
+    for (size_t i = 0; i < times; i++) {
+        memcpy(text->data + text->length, piece, length);
+        text->length += length;
+    }
+    text->data[text->length] = '\0';
+}
+
+typedef struct {
+    int errors;
+    int too_deep; // "Nesting deeper than" diagnostics
+} Diagnostics;
+
+static void count_diagnostic(void *user_data, const char *message) {
+    Diagnostics *diagnostics = user_data;
+    diagnostics->errors++;
+    if (strstr(message, "Nesting deeper than")) diagnostics->too_deep++;
+}
+
+// The parsed program and what was reported while compiling it
+typedef struct {
+    Diagnostics parse;
+    Diagnostics total;
+    uint32_t statements; // Top-level statements
+    int last_type; // ASTNodeType of the last of them, -1 if there are none
+    uint32_t prints; // Print statements anywhere in the tree
+} Outcome;
+
+// Parse, print and check input like the driver does, with the AST printout discarded
+static Outcome compile(const char *input) {
+    Outcome outcome = {{0}, {0}, 0, -1, 0};
+    CompilerContext ctx;
+    context_init(&ctx);
+    context_set_diagnostic_handler(&ctx, count_diagnostic, &outcome.total);
+
+    parser_init(&ctx, input);
+    ASTNode *ast = parse(&ctx);
+    outcome.parse = outcome.total;
+    outcome.statements = ast ? ast->count : 0;
+    if (outcome.statements) outcome.last_type = ast->items[outcome.statements - 1]->type;
+
+    FlatAST flat;
+    flat_ast_init(&flat);
+    if (flat_ast_build(&flat, ast) != 0) {
+        fprintf(stderr, "out of memory\n");
+        exit(2);
+    }
+    for (uint32_t i = 0; i < flat.count; i++) {
+        outcome.prints += flat.nodes[i].type == AST_PRINT;
+    }
+    flat_ast_free(&flat);
+
+    print_ast(&ctx, ast, 0);
+    analyze_semantics(&ctx, ast);
+    context_free(&ctx);
+    return outcome;
+}
+
+static int failures;
+
+static void expect_int(const char *what, long actual, long expected) {
+    if (actual != expected) {
+        fprintf(stderr, "FAIL %s: %ld, expected %ld\n", what, actual, expected);
+        failures++;
+    }
+}
+
+// "if (a) {" nested depth times around a stray "if (a) }", then three statements
+static void stray_close(Text *text, size_t depth) {
+    text->length = 0;
+    append(text, "int a;\na = 1;\n", 1);
+    append(text, "if (a) {", depth);
+    append(text, "if (a) }", 1);
+    append(text, "}", depth);
+    append(text, "\nint b;\nb = 2;\nprint b;\n", 1);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <parens | blocks | if | while | repeat | chain | unclosed | stray>\n", argv[0]);
+        return 2;
+    }
+    const char *name = argv[1];
+    Text text = {0};
+
+    // The AST printout and symbol table dumps are not what is tested
+    if (!freopen("/dev/null", "w", stdout)) {
+        perror("/dev/null");
+        return 2;
+    }
+
+    if (strcmp(name, "parens") == 0) {
+        append(&text, "int a;\na = ", 1);
+        append(&text, "(", DEPTH);
+        append(&text, "1", 1);
+        append(&text, ")", DEPTH);
+        append(&text, ";\nprint a;\n", 1);
+        Outcome outcome = compile(text.data);
+        expect_int("nesting diagnostics", outcome.total.too_deep, 1);
+        expect_int("parse errors", outcome.parse.errors, 1);
+        expect_int("statements", outcome.statements, 3);
+        expect_int("last statement", outcome.last_type, AST_PRINT);
+    } else if (strcmp(name, "blocks") == 0) {
+        append(&text, "{", DEPTH);
+        append(&text, "int x;", 1);
+        append(&text, "}", DEPTH);
+        append(&text, "\nint y;\n", 1);
+        Outcome outcome = compile(text.data);
+        expect_int("nesting diagnostics", outcome.total.too_deep, 1);
+        expect_int("parse errors", outcome.parse.errors, 1);
+        expect_int("statements", outcome.statements, 2);
+        expect_int("last statement", outcome.last_type, AST_VARDECL);
+    } else if (strcmp(name, "if") == 0 || strcmp(name, "while") == 0) {
+        // Each body lacks its braces, which is an error at every level, but the
+        // bodies still nest; past the limit the rest of the chain is skipped. The
+        // recovered bodies run to the '}', so the print ends up nested in them.
+        append(&text, "int a;\na = 1;\n", 1);
+        append(&text, strcmp(name, "if") == 0 ? "if (a) " : "while (a) ", DEPTH);
+        append(&text, "a = 2;\n}\nprint a;\n", 1);
+        Outcome outcome = compile(text.data);
+        expect_int("nesting diagnostics", outcome.total.too_deep, 1);
+        expect_int("print statements", outcome.prints, 1);
+    } else if (strcmp(name, "repeat") == 0) {
+        append(&text, "int a;\na = 1;\n", 1);
+        append(&text, "repeat ", DEPTH);
+        append(&text, "a = 2;\n}\nprint a;\n", 1);
+        Outcome outcome = compile(text.data);
+        expect_int("nesting diagnostics", outcome.total.too_deep, 1);
+        expect_int("print statements", outcome.prints, 1);
+    } else if (strcmp(name, "chain") == 0) {
+        // Not nesting, so nothing is skipped: the whole chain is parsed and walked
+        append(&text, "int a;\na = 1;\na = a", 1);
+        append(&text, " + a", DEPTH - 1);
+        append(&text, ";\nprint a;\n", 1);
+        Outcome outcome = compile(text.data);
+        expect_int("nesting diagnostics", outcome.total.too_deep, 0);
+        expect_int("parse errors", outcome.parse.errors, 0);
+        expect_int("statements", outcome.statements, 4);
+        expect_int("last statement", outcome.last_type, AST_PRINT);
+    } else if (strcmp(name, "unclosed") == 0) {
+        append(&text, "int a;\na = ", 1);
+        append(&text, "(", DEPTH);
+        append(&text, "\n", 1);
+        append(&text, "{", DEPTH);
+        Outcome outcome = compile(text.data);
+        expect_int("nesting diagnostics", outcome.total.too_deep, 1);
+    } else if (strcmp(name, "stray") == 0) {
+        // A stray '}' as the body at the depth limit must be reported like one a
+        // level shallower, and one past the limit must not swallow the statements
+        // after it either
+        stray_close(&text, PARSER_MAX_DEPTH - 2);
+        Outcome shallower = compile(text.data);
+        stray_close(&text, PARSER_MAX_DEPTH - 1);
+        Outcome at_limit = compile(text.data);
+        stray_close(&text, PARSER_MAX_DEPTH);
+        Outcome past_limit = compile(text.data);
+        expect_int("nesting diagnostics", at_limit.total.too_deep, 0);
+        expect_int("statements", at_limit.statements, shallower.statements);
+        expect_int("last statement", at_limit.last_type, shallower.last_type);
+        expect_int("print statements", at_limit.prints, 1);
+        expect_int("print statements, shallower", shallower.prints, 1);
+        expect_int("nesting diagnostics past the limit", past_limit.total.too_deep, 1);
+        expect_int("print statements past the limit", past_limit.prints, 1);
+    } else {
+        fprintf(stderr, "unknown test '%s'\n", name);
+        return 2;
+    }
+
+    free(text.data);
+    if (failures) return 1;
+    fprintf(stderr, "%s: ok\n", name);
+    return 0;
+}
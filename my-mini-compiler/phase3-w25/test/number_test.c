@@ -0,0 +1,89 @@
+/* number_test.c */
+// Checks decimal literal conversion on the slow path against strtod() in the "C"
+// locale, then again under a locale whose decimal point is ',' (such as de_DE),
+// which must not change the result. Exits 77, skipped, if no such locale is installed.
+//
+//     number_test
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/number.h"
+
+#define SKIPPED 77
+
+// Locales tried for a ',' decimal point
+static const char *const comma_locales[] = {
+    "de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "fr_FR.utf8", "fr_FR", "ru_RU.UTF-8", "ru_RU.utf8"
+};
+
+// Literals too long or too precise for the fast path
+static const char *const literals[] = {
+    "3.14159265358979323846264338327950288",
+    "0.1000000000000000055511151231257827021181583404541015625",
+    "123456789012345678901234567890.5",
+    "0.000000000000000000000000000001",
+    "9007199254740993.0", // 2^53 + 1: halfway, rounds to even
+    "0.00000000000000000000000000000000000000000000000000",
+};
+
+// Text of n copies of piece followed by tail
+static char *repeated(const char *head, const char *piece, int n, const char *tail) {
+    size_t length = strlen(head) + strlen(piece) * n + strlen(tail);
+    char *text = malloc(length + 1);
+    if (!text) {
+        fprintf(stderr, "out of memory\n");
+        exit(2);
+    }
+    strcpy(text, head);
+    for (int i = 0; i < n; i++) strcat(text, piece);
+    strcat(text, tail);
+    return text;
+}
+
+static int failures;
+
+static void check_all(const char *where, char **texts, const double *expected, int count) {
+    for (int i = 0; i < count; i++) {
+        NumberValue number = convert_number(texts[i], (int) strlen(texts[i]));
+        if (!(number.flags & NUMBER_DECIMAL) || memcmp(&number.decimal, &expected[i], sizeof(double)) != 0) {
+            fprintf(stderr, "FAIL %s: %.40s... converted to %.17g, expected %.17g\n", where, texts[i],
+                    number.decimal, expected[i]);
+            failures++;
+        }
+    }
+}
+
+int main(void) {
+    enum { FIXED = sizeof(literals) / sizeof(literals[0]), COUNT = FIXED + 3 };
+    char *texts[COUNT];
+    for (int i = 0; i < FIXED; i++) texts[i] = repeated(literals[i], "", 0, "");
+    // More digits than can decide the rounding, which then hinges on a non-zero far out
+    texts[FIXED] = repeated("9007199254740993.", "0", 900, "1");
+    texts[FIXED + 1] = repeated("0.", "3", 1200, "");
+    // Out of range
+    texts[FIXED + 2] = repeated("1", "0", 400, ".5");
+
+    // The lexeme as strtod() reads it in the "C" locale is the reference
+    double expected[COUNT];
+    for (int i = 0; i < COUNT; i++) expected[i] = strtod(texts[i], NULL);
+    check_all("C locale", texts, expected, COUNT);
+
+    const char *comma = NULL;
+    for (size_t i = 0; i < sizeof(comma_locales) / sizeof(comma_locales[0]) && !comma; i++) {
+        if (setlocale(LC_NUMERIC, comma_locales[i]) && strcmp(localeconv()->decimal_point, ",") == 0) {
+            comma = comma_locales[i];
+        }
+    }
+    if (comma) check_all(comma, texts, expected, COUNT);
+
+    for (int i = 0; i < COUNT; i++) free(texts[i]);
+    if (failures) return 1;
+    if (!comma) {
+        fprintf(stderr, "number conversion: ok in the C locale; no locale with a ',' decimal point, skipped\n");
+        return SKIPPED;
+    }
+    fprintf(stderr, "number conversion: ok, also under %s\n", comma);
+    return 0;
+}
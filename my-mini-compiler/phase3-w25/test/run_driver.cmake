@@ -0,0 +1,21 @@
+# run_driver.cmake
+# Runs the compiler driver on one input and checks its exit status and output;
+# a crash or a hang fails the check like a wrong status does.
+#
+#     cmake -DDRIVER=<driver> -DINPUT=<source file> -DEXPECT_EXIT=<status>
+#           [-DEXPECT_OUTPUT=<regex>] [-DREJECT_OUTPUT=<regex>] -P run_driver.cmake
+execute_process(COMMAND ${DRIVER} ${INPUT}
+        RESULT_VARIABLE status
+        OUTPUT_VARIABLE output
+        ERROR_VARIABLE output
+        TIMEOUT 10)
+
+if (NOT status STREQUAL EXPECT_EXIT)
+    message(FATAL_ERROR "${INPUT}: exit status '${status}', expected ${EXPECT_EXIT}\n${output}")
+endif ()
+if (DEFINED EXPECT_OUTPUT AND NOT output MATCHES "${EXPECT_OUTPUT}")
+    message(FATAL_ERROR "${INPUT}: no output matching '${EXPECT_OUTPUT}'\n${output}")
+endif ()
+if (DEFINED REJECT_OUTPUT AND output MATCHES "${REJECT_OUTPUT}")
+    message(FATAL_ERROR "${INPUT}: output matches '${REJECT_OUTPUT}'\n${output}")
+endif ()
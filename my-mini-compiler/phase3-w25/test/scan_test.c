@@ -0,0 +1,100 @@
+/* scan_test.c */
+// Checks that every scanner level the machine supports agrees with the scalar
+// scanners, on pseudo-random text heavy in the bytes they stop at, from every
+// start offset within a vector block.
+//
+//     scan_test
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/scan.h"
+
+#define LENGTH 4096
+#define ROUNDS 64
+
+static const char *const level_names[] = {
+    [SCAN_LEVEL_SCALAR] = "scalar",
+    [SCAN_LEVEL_SSE2] = "sse2",
+    [SCAN_LEVEL_AVX2] = "avx2"
+};
+
+// Results of every scanner from one start offset
+typedef struct {
+    const char *whitespace;
+    const char *line_end;
+    const char *block_comment;
+    const char *identifier;
+    const char *digits;
+    size_t newlines;
+    uint32_t last_newline;
+} Scans;
+
+static Scans scan_all(const char *p, size_t length, uint32_t *offsets) {
+    Scans scans;
+    scans.whitespace = scan_whitespace(p);
+    scans.line_end = scan_line_end(p);
+    scans.block_comment = scan_block_comment(p);
+    scans.identifier = scan_identifier(p);
+    scans.digits = scan_digits(p);
+    scans.newlines = scan_newlines(p, length, offsets);
+    scans.last_newline = scans.newlines ? offsets[scans.newlines - 1] : 0;
+    return scans;
+}
+
+static int same_scans(const Scans *a, const Scans *b) {
+    return a->whitespace == b->whitespace && a->line_end == b->line_end && a->block_comment == b->block_comment &&
+           a->identifier == b->identifier && a->digits == b->digits && a->newlines == b->newlines &&
+           a->last_newline == b->last_newline;
+}
+
+// Runs of bytes each scanner stops at or skips, so scans end at varying distances
+static void fill(char *text, size_t length, uint32_t *seed) {
+    static const char bytes[] = "  \t\n\n*/*abcXYZ_09871234;(\xc3\xa9\x80";
+    size_t i = 0;
+    while (i < length) {
+        *seed = *seed * 1103515245u + 12345u;
+        char c = bytes[(*seed >> 16) % (sizeof(bytes) - 1)];
+        size_t run = 1 + (*seed >> 8) % 48;
+        for (; run && i < length; run--) text[i++] = c;
+    }
+    text[length] = '\0';
+}
+
+int main(void) {
+    char *text = malloc(LENGTH + 1);
+    uint32_t *offsets = malloc(LENGTH * sizeof(uint32_t));
+    if (!text || !offsets) {
+        fprintf(stderr, "out of memory\n");
+        return 2;
+    }
+
+    ScanLevel best = scan_best_level();
+    int failures = 0;
+    uint32_t seed = 1;
+    for (int round = 0; round < ROUNDS; round++) {
+        fill(text, LENGTH, &seed);
+        for (size_t start = 0; start < 64; start++) {
+            const char *p = text + start;
+            size_t length = LENGTH - start;
+            scan_set_level(SCAN_LEVEL_SCALAR);
+            Scans expected = scan_all(p, length, offsets);
+
+            for (int level = SCAN_LEVEL_SSE2; level <= (int) best; level++) {
+                scan_set_level((ScanLevel) level);
+                Scans actual = scan_all(p, length, offsets);
+                if (!same_scans(&actual, &expected)) {
+                    fprintf(stderr, "FAIL %s: round %d, start %zu differs from scalar\n", level_names[level], round,
+                            start);
+                    failures++;
+                }
+            }
+        }
+    }
+
+    free(offsets);
+    free(text);
+    if (failures) return 1;
+    fprintf(stderr, "scanners up to %s: ok\n", level_names[best]);
+    return 0;
+}
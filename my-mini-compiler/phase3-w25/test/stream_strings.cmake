@@ -0,0 +1,33 @@
+# stream_strings.cmake
+# Lexes string literals longer than the streaming lexer's window both ways, with
+# --tokens through the window and with --dump-tokens over the whole buffer, and
+# checks the two print the same tokens.
+#
+#     cmake -DDRIVER=<driver> -DDUMP_TEXT=<token_dump_text> -DWORK_DIR=<dir> -P stream_strings.cmake
+string(REPEAT "x" 100000 long)
+string(REPEAT "y" 300000 longer)
+set(input "${WORK_DIR}/stream_strings.txt")
+file(WRITE "${input}" "int a;\nstring s;\ns = \"${long}\";\nprint s;\ns = \"${longer}\nacross lines\";\nprint a;\ns = \"${long}")
+
+execute_process(COMMAND ${DRIVER} --tokens ${input}
+        RESULT_VARIABLE status OUTPUT_VARIABLE streamed TIMEOUT 30)
+if (NOT status EQUAL 0)
+    message(FATAL_ERROR "--tokens: exit status '${status}'")
+endif ()
+execute_process(COMMAND ${DRIVER} --dump-tokens ${input} ${input}.dump
+        RESULT_VARIABLE status TIMEOUT 30)
+if (NOT status EQUAL 0)
+    message(FATAL_ERROR "--dump-tokens: exit status '${status}'")
+endif ()
+execute_process(COMMAND ${DUMP_TEXT} ${input}.dump ${input}
+        RESULT_VARIABLE status OUTPUT_VARIABLE whole TIMEOUT 30)
+if (NOT status EQUAL 0)
+    message(FATAL_ERROR "token_dump_text: exit status '${status}'")
+endif ()
+
+if (NOT streamed STREQUAL whole)
+    message(FATAL_ERROR "streamed tokens differ from whole-buffer tokens")
+endif ()
+if (streamed MATCHES "too long")
+    message(FATAL_ERROR "a long string was reported as an error")
+endif ()
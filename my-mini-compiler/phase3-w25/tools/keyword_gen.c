@@ -0,0 +1,105 @@
+/* keyword_gen.c */
+// Build-time generator for keywords.h: turns the declarative keyword list in
+// keywords.def into a classifier that switches on the identifier length and
+// first character, so a lookup costs at most one short memcmp per candidate.
+#include <stdio.h>
+#include <string.h>
+
+static struct {
+    const char *word;
+    const char *type;
+} keywords[] = {
+#define KEYWORD(word, type) {#word, #type},
+#include "../include/keywords.def"
+#undef KEYWORD
+};
+
+static const int keyword_count = sizeof(keywords) / sizeof(keywords[0]);
+
+static int max_length(void) {
+    int max = 0;
+    for (int i = 0; i < keyword_count; i++) {
+        int length = (int) strlen(keywords[i].word);
+        if (length > max) max = length;
+    }
+    return max;
+}
+
+// Emit the nested length / first character switch
+static void emit_lookup(FILE *out) {
+    int max = max_length();
+
+    fprintf(out, "// Classify the identifier word[0..length) as a keyword, returns 0 if it is not one\n");
+    fprintf(out, "static inline int keyword_lookup(const char *word, int length) {\n");
+    fprintf(out, "    switch (length) {\n");
+    for (int length = 1; length <= max; length++) {
+        int has_length = 0;
+        for (int i = 0; i < keyword_count; i++) {
+            if ((int) strlen(keywords[i].word) == length) has_length = 1;
+        }
+        if (!has_length) continue;
+
+        fprintf(out, "        case %d:\n", length);
+        fprintf(out, "            switch (word[0]) {\n");
+        for (int c = 0; c < 256; c++) {
+            int has_first = 0;
+            for (int i = 0; i < keyword_count; i++) {
+                if ((int) strlen(keywords[i].word) == length && (unsigned char) keywords[i].word[0] == c) {
+                    has_first = 1;
+                }
+            }
+            if (!has_first) continue;
+
+            fprintf(out, "                case '%c':\n", c);
+            for (int i = 0; i < keyword_count; i++) {
+                if ((int) strlen(keywords[i].word) != length || (unsigned char) keywords[i].word[0] != c) continue;
+                if (length == 1) {
+                    fprintf(out, "                    return %s;\n", keywords[i].type);
+                } else {
+                    fprintf(out, "                    if (memcmp(word + 1, \"%s\", %d) == 0) return %s;\n",
+                            keywords[i].word + 1, length - 1, keywords[i].type);
+                }
+            }
+            fprintf(out, "                    break;\n");
+        }
+        fprintf(out, "            }\n");
+        fprintf(out, "            break;\n");
+    }
+    fprintf(out, "    }\n");
+    fprintf(out, "    return 0;\n");
+    fprintf(out, "}\n");
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <output header>\n", argv[0]);
+        return 1;
+    }
+
+    for (int i = 0; i < keyword_count; i++) {
+        for (int j = 0; j < i; j++) {
+            if (strcmp(keywords[i].word, keywords[j].word) == 0) {
+                fprintf(stderr, "keywords.def: duplicate keyword '%s'\n", keywords[i].word);
+                return 1;
+            }
+        }
+    }
+
+    FILE *out = fopen(argv[1], "w");
+    if (!out) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    fprintf(out, "/* keywords.h - generated by keyword_gen from keywords.def, do not edit */\n");
+    fprintf(out, "#ifndef KEYWORDS_H\n");
+    fprintf(out, "#define KEYWORDS_H\n\n");
+    fprintf(out, "#include <string.h>\n\n");
+    fprintf(out, "#include \"tokens.h\"\n\n");
+    fprintf(out, "#define KEYWORD_COUNT %d\n", keyword_count);
+    fprintf(out, "#define KEYWORD_MAX_LENGTH %d\n\n", max_length());
+    emit_lookup(out);
+    fprintf(out, "\n#endif /* KEYWORDS_H */\n");
+
+    return fclose(out) == 0 ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+/* lexer_bench.c */
+// Lexer microbenchmark: tokenizes a source file repeatedly and reports the
+// best-of-N throughput in tokens, identifiers and bytes per second, both pulling
+// one token at a time and batch lexing into a TokenBuffer, sequentially and on
+// several threads, and the UTF-8 validation pass that precedes lexing. Then times
+// incremental re-lexing after one-byte edits.
+//
+//     lexer_bench <source file> [repetitions] [threads]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../include/incremental_lexer.h"
+#include "../include/lexer.h"
+#include "../include/parallel_lexer.h"
+#include "../include/utf8.h"
+
+static char *read_file(const char *path, long *size) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    *size = ftell(file);
+    rewind(file);
+
+    char *buffer = malloc(*size + 1);
+    if (buffer && fread(buffer, 1, *size, file) != (size_t) *size) {
+        free(buffer);
+        buffer = NULL;
+    }
+    if (buffer) buffer[*size] = '\0';
+    fclose(file);
+    return buffer;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <source file> [repetitions] [threads]\n", argv[0]);
+        return 1;
+    }
+    int repetitions = argc > 2 ? atoi(argv[2]) : 10;
+    int threads = argc > 3 ? atoi(argv[3]) : 0;
+
+    long size;
+    char *input = read_file(argv[1], &size);
+    if (!input) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    long tokens = 0;
+    long identifiers = 0;
+    double best = -1;
+    for (int r = 0; r < repetitions; r++) {
+        Lexer lexer;
+        Token token;
+        tokens = 0;
+        identifiers = 0;
+
+        double start = now_seconds();
+        lexer_init(&lexer, input);
+        do {
+            token = get_next_token(&lexer);
+            tokens++;
+            identifiers += token.type == TOKEN_IDENTIFIER;
+        } while (token.type != TOKEN_EOF);
+        double elapsed = now_seconds() - start;
+
+        if (best < 0 || elapsed < best) best = elapsed;
+    }
+
+    printf("%ld bytes, %ld tokens, %ld identifiers\n", size, tokens, identifiers);
+    printf("get_next_token, best of %d: %.3f ms | %.2f M tokens/s | %.2f M identifiers/s | %.1f MB/s\n",
+           repetitions, best * 1e3, tokens / best / 1e6, identifiers / best / 1e6, size / best / 1e6);
+
+    size_t invalid = 0;
+    best = -1;
+    for (int r = 0; r < repetitions; r++) {
+        double start = now_seconds();
+        invalid = utf8_validate(input, (size_t) size);
+        double elapsed = now_seconds() - start;
+
+        if (best < 0 || elapsed < best) best = elapsed;
+    }
+    printf("utf8_validate,  best of %d: %.3f ms | %.1f MB/s | ", repetitions, best * 1e3, size / best / 1e6);
+    if (invalid == (size_t) size) {
+        printf("valid\n");
+    } else {
+        printf("invalid at byte %zu\n", invalid);
+    }
+
+    // Batch lexing; the buffer is reused so only the first run pays for growing it
+    TokenBuffer buffer;
+    token_buffer_init(&buffer);
+    best = -1;
+    for (int r = 0; r < repetitions; r++) {
+        Lexer lexer;
+        buffer.count = 0;
+
+        double start = now_seconds();
+        lexer_init(&lexer, input);
+        if (lex_all(&lexer, &buffer) != 0) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+        double elapsed = now_seconds() - start;
+
+        if (best < 0 || elapsed < best) best = elapsed;
+    }
+    printf("lex_all,        best of %d: %.3f ms | %.2f M tokens/s | %.1f MB/s\n",
+           repetitions, best * 1e3, buffer.count / best / 1e6, size / best / 1e6);
+
+    best = -1;
+    for (int r = 0; r < repetitions; r++) {
+        Lexer lexer;
+        buffer.count = 0;
+
+        double start = now_seconds();
+        lexer_init(&lexer, input);
+        if (lex_all_parallel(&lexer, &buffer, threads) != 0) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+        double elapsed = now_seconds() - start;
+
+        if (best < 0 || elapsed < best) best = elapsed;
+    }
+    printf("lex_all_parallel (%d threads), best of %d: %.3f ms | %.2f M tokens/s | %.1f MB/s\n",
+           threads, repetitions, best * 1e3, buffer.count / best / 1e6, size / best / 1e6);
+
+    // Incremental re-lexing, as after a keystroke: insert a space at a pseudo-random
+    // offset, re-lex, then delete it again and re-lex
+    char *edited = malloc(size + 2);
+    if (!edited) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    memcpy(edited, input, size + 1);
+    Lexer lexer;
+    lexer_init(&lexer, edited);
+    buffer.count = 0;
+    if (lex_all(&lexer, &buffer) != 0) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    int edits = 0;
+    double total = 0;
+    double worst = 0;
+    uint32_t seed = 1;
+    for (int r = 0; r < repetitions * 100; r++) {
+        seed = seed * 1103515245u + 12345u;
+        uint32_t offset = (uint32_t) (seed % (uint32_t) (size + 1));
+
+        for (int undo = 0; undo < 2; undo++) {
+            if (undo) {
+                memmove(edited + offset, edited + offset + 1, size - offset + 1);
+            } else {
+                memmove(edited + offset + 1, edited + offset, size - offset + 1);
+                edited[offset] = ' ';
+            }
+            LexEdit edit = {offset, (uint32_t) undo, (uint32_t) !undo};
+            TokenRange changed;
+
+            double start = now_seconds();
+            if (lex_edit(&lexer, &buffer, &edit, &changed) != 0) {
+                fprintf(stderr, "out of memory\n");
+                return 1;
+            }
+            double elapsed = now_seconds() - start;
+
+            total += elapsed;
+            if (elapsed > worst) worst = elapsed;
+            edits++;
+        }
+    }
+    printf("lex_edit, %d one-byte edits: mean %.1f us | worst %.1f us\n", edits, total / edits * 1e6, worst * 1e6);
+    token_buffer_free(&buffer);
+
+    free(edited);
+    free(input);
+    return 0;
+}
@@ -0,0 +1,62 @@
+/* token_dump_text.c */
+// Prints a binary token dump (see token_dump.h) exactly as `my-mini-compiler
+// --tokens` prints the tokens of the source it was made from:
+//
+//     token_dump_text <dump file> <source file>
+#include <stdio.h>
+
+#include "../include/lexer.h"
+#include "../include/source.h"
+#include "../include/token_dump.h"
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <dump file> <source file>\n", argv[0]);
+        return 2;
+    }
+
+    SourceFile dump;
+    SourceFile source;
+    if (source_open(&dump, argv[1]) != 0) {
+        perror(argv[1]);
+        return 2;
+    }
+    if (source_open(&source, argv[2]) != 0) {
+        perror(argv[2]);
+        source_close(&dump);
+        return 2;
+    }
+
+    int status = 0;
+    TokenDumpReader reader;
+    if (token_dump_open(&reader, dump.data, dump.size) != 0) {
+        fprintf(stderr, "%s: not a token dump\n", argv[1]);
+        status = 2;
+    } else if (reader.source_size != source.size) {
+        fprintf(stderr, "%s: dump is of a %llu byte source, %s has %zu bytes\n", argv[1],
+                (unsigned long long) reader.source_size, argv[2], source.size);
+        status = 2;
+    }
+
+    // Lines come from the dump; columns need the line starts, so the source map
+    // is only built if an error token asks for one
+    SourceMap map;
+    source_map_init(&map, source.data);
+    Token token;
+    uint64_t line;
+    int read;
+    while (status == 0 && (read = token_dump_next(&reader, &token, &line)) == 1) {
+        SourceLocation location = {(int) line, 0};
+        if (token.error != ERROR_NONE) location = source_locate(&map, (uint32_t) token.offset);
+        print_token(token, source.data, location);
+    }
+    if (status == 0 && read < 0) {
+        fprintf(stderr, "%s: corrupt token dump\n", argv[1]);
+        status = 2;
+    }
+
+    source_map_free(&map);
+    source_close(&source);
+    source_close(&dump);
+    return status;
+}